@@ -0,0 +1,122 @@
+/*
+    Compares the time of the optimistic planning of UCBVI with Bernstein bonuses (single pass over the observed
+    next states per state-action pair) with the previous implementation (copy of the next stage values, one pass
+    for the mean, one for the variance and one for the expected value).
+
+    To run this example:
+    $ bash scripts/compile.sh bernstein_benchmark && ./build/examples/bernstein_benchmark
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include "mdp.h"
+#include "ucbvi.h"
+#include "utils.h"
+
+using namespace std;
+
+/*
+    Previous planning path, computed from the public estimates of algo: at each stage, the bonuses of all
+    state-action pairs are computed from a copy of the next stage values, with one pass for the mean of the next
+    state value and one for its variance, then Q is computed with another pass. Returns V.
+*/
+utils::vec::vec_2d two_pass_planning(const online::UCBVI& algo, int ns, int na, int horizon)
+{
+    double delta = 0.1;   // confidence parameter used by UCBVI
+    utils::vec::vec_2d V = utils::vec::get_zeros_2d(horizon + 1, ns);
+    utils::vec::tensor_3d Q(horizon + 1, ns, na);
+    utils::vec::tensor_3d bonus(horizon, ns, na);
+    utils::vec::ivec_2d policy = utils::vec::get_zeros_i2d(horizon, ns);
+
+    for (int h = horizon - 1; h >= 0; h--)
+    {
+        // compute_bernstein_bonus(h, V[h+1]), with the values passed by copy
+        std::vector<double> Vhp1 = V[h+1];
+        for (int s = 0; s < ns; s++)
+        {
+            for (int a = 0; a < na; a++)
+            {
+                int pair = s*na + a;
+                const std::vector<int>& next_states = algo.successors[pair];
+                const std::vector<int>& counts = algo.successor_counts[pair];
+                double mean = 0, var = 0;
+                for (std::size_t k = 0; k < next_states.size(); k++) mean += counts[k]*Vhp1[next_states[k]];
+                mean *= algo.inv_N_sa[s][a];
+                for (std::size_t k = 0; k < next_states.size(); k++)
+                {
+                    double diff = Vhp1[next_states[k]] - mean;
+                    var += counts[k]*diff*diff;
+                }
+                var *= algo.inv_N_sa[s][a];
+
+                double L = std::log(5 * ns * na * std::max(1, algo.N_sa[s][a]) / delta);
+                double n = std::max(1, algo.N_sa[s][a]);
+                double T1 = sqrt(8 * L * var / n) + 14 * L * horizon / (3*n);
+                double T2 = sqrt(8 * horizon * horizon / n);
+                bonus(h, s, a) = algo.scale_factor * (T1 + T2);
+            }
+        }
+
+        // backups
+        for (int s = 0; s < ns; s++)
+        {
+            for (int a = 0; a < na; a++)
+            {
+                int pair = s*na + a;
+                double sum = mdp::bellman::weighted_sum(algo.successor_counts[pair].data(),
+                                                        algo.successors[pair].data(), V[h+1].data(),
+                                                        algo.successors[pair].size());
+                double tmp = (algo.N_sa[s][a] == 0) ? 0 : (algo.R_sum[s][a] + sum)*algo.inv_N_sa[s][a];
+                double noise = 1e-10 * std::rand()/(RAND_MAX + 1u);
+                Q(h, s, a) = tmp + bonus(h, s, a) + noise;
+                if ((a == 0) || (Q(h, s, a) > V[h][s]))
+                {
+                    V[h][s] = Q(h, s, a);
+                    policy[h][s] = a;
+                }
+            }
+            V[h][s] = std::min((double)(horizon - h + 2), V[h][s]);
+        }
+    }
+    return V;
+}
+
+void benchmark(mdp::FiniteMDP& mdp, int horizon, int n_episodes, int n_repetitions)
+{
+    online::UCBVI algo(mdp, horizon, 0.1, "bernstein", false);
+    for (int k = 0; k < n_episodes; k++) algo.run_episode();
+
+    utils::vec::vec_2d V_ref;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < n_repetitions; i++) V_ref = two_pass_planning(algo, mdp.ns, mdp.na, horizon);
+    double two_pass_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < n_repetitions; i++) algo.get_optimistic_q();
+    double fused_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double max_diff = 0;
+    for (int h = 0; h < horizon; h++)
+        for (int s = 0; s < mdp.ns; s++)
+            max_diff = std::max(max_diff, std::abs(algo.V[h][s] - V_ref[h][s]));
+
+    cout << mdp.id << " (S = " << mdp.ns << ", A = " << mdp.na << ", H = " << horizon << ")" << endl;
+    cout << "    two-pass planning: " << 1000*two_pass_time/n_repetitions << " ms" << endl;
+    cout << "    fused planning:    " << 1000*fused_time/n_repetitions << " ms" << endl;
+    cout << "    max |V_fused - V_two_pass| = " << max_diff << endl;
+}
+
+int main(void)
+{
+    mdp::Chain chain(200, 0.1);
+    benchmark(chain, 50, 200, 20);
+
+    mdp::GridWorld gridworld(40, 40, 0.2, 0.1);
+    benchmark(gridworld, 50, 200, 20);
+
+    return 0;
+}
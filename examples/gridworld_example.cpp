@@ -76,13 +76,13 @@ int main(void)
     */
     int state = 0; 
     std::cout << "Transitions at state " << state << ", action left: " << std::endl;
-    mdp.render_values(mdp.transitions[state][0]);
+    mdp.render_values(mdp.transitions.dense_row(state, 0));
     std::cout << "Transitions at state " << state << ", action right: " << std::endl;
-    mdp.render_values(mdp.transitions[state][1]);
+    mdp.render_values(mdp.transitions.dense_row(state, 1));
     std::cout << "Transitions at state " << state << ", action up: " << std::endl;
-    mdp.render_values(mdp.transitions[state][2]);
+    mdp.render_values(mdp.transitions.dense_row(state, 2));
     std::cout << "Transitions at state " << state << ", action down: " << std::endl;
-    mdp.render_values(mdp.transitions[state][3]);
+    mdp.render_values(mdp.transitions.dense_row(state, 3));
 
     return 0;
 }
@@ -0,0 +1,30 @@
+/*
+    Converts a binary history file, written by History<int, int>::to_binary(), to a csv file that can be read by
+    python/read_data.py.
+
+    To run this example:
+    $ bash scripts/compile.sh history_to_csv && ./build/examples/history_to_csv data/temp.bin data/temp.csv
+*/
+
+#include <iostream>
+#include <string>
+#include "mdp.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        cerr << "Usage: " << argv[0] << " history.bin history.csv" << endl;
+        return 1;
+    }
+
+    mdp::HistoryReader reader(argv[1]);
+    if (!reader.is_open()) return 1;
+    cout << argv[1] << ": " << reader.length() << " steps, " << reader.n_extra_variables() << " extra variables";
+    for (int j = 0; j < reader.n_extra_variables(); j++) cout << (j == 0 ? " (" : ", ") << reader.extra_name(j);
+    cout << (reader.n_extra_variables() > 0 ? ")" : "") << endl;
+
+    return reader.to_csv(argv[2]) ? 0 : 1;
+}
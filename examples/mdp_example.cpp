@@ -57,8 +57,9 @@ int main(void)
     // print history
     mdp.history.print(max_t);
 
-    // save history in csv file
+    // save history in csv file, and in binary file (see examples/history_to_csv.cpp to convert it to csv)
     mdp.history.to_csv("data/temp.csv");
+    mdp.history.to_binary("data/temp.bin");
 
     
     /* 
@@ -69,7 +70,8 @@ int main(void)
     
      */
 
-    mdp::MountainCar env;
+    // MountainCar has states of type mdp::StaticState<2>: the adapter gives states of type std::vector<double>
+    mdp::DynamicContinuousMDP<mdp::MountainCar> env;
     std::cout << env.id << std::endl;
 
     env.history.reserve_mem(max_t, 0);
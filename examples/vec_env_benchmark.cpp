@@ -0,0 +1,129 @@
+/*
+    Compares the number of steps per second of FiniteMDP::step() and of VecFiniteMDP::step(), which steps many
+    independent copies of the MDP sharing the same model, and of MountainCar::step(), MountainCar::step_inline() and
+    VecMountainCar::step().
+
+    To run this example:
+    $ bash scripts/compile.sh vec_env_benchmark && ./build/examples/vec_env_benchmark
+*/
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include "mdp.h"
+#include "utils.h"
+
+using namespace std;
+
+void benchmark(mdp::FiniteMDP& mdp, int n_envs, int n_steps)
+{
+    utils::rand::Random randgen(1);
+    std::vector<int> actions(n_envs);
+    for (int i = 0; i < n_envs; i++) actions[i] = randgen.sample_real_uniform(0, 1)*mdp.na;
+
+    // single environment
+    long checksum = 0;
+    mdp.reset();
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < n_steps; t++)
+    {
+        for (int i = 0; i < n_envs; i++)
+        {
+            mdp::StepResult<int> result = mdp.step(actions[i]);
+            checksum += result.next_state;
+            if (result.done) mdp.reset();
+        }
+    }
+    double single_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // vectorized environment
+    mdp::VecFiniteMDP env(mdp, n_envs);
+    mdp::StepBatch out;
+    start = chrono::steady_clock::now();
+    for (int t = 0; t < n_steps; t++)
+    {
+        env.step(actions.data(), out);
+        checksum += out.next_states[0];
+    }
+    double vec_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double total_steps = ((double) n_envs)*n_steps;
+    cout << mdp.id << " (S = " << mdp.ns << ", A = " << mdp.na << "), " << n_envs << " environments" << endl;
+    cout << "    FiniteMDP::step:    " << total_steps/single_time/1e6 << " M steps/s" << endl;
+    cout << "    VecFiniteMDP::step: " << total_steps/vec_time/1e6 << " M steps/s" << endl;
+    cout << "    (checksum " << checksum << ")" << endl;
+}
+
+void benchmark_mountain_car(int n_envs, int n_steps)
+{
+    utils::rand::Random randgen(1);
+    std::vector<int> actions(n_envs);
+    for (int i = 0; i < n_envs; i++) actions[i] = std::min(2, (int) (3*randgen.sample_real_uniform(0, 1)));
+
+    // single environment
+    mdp::MountainCar mountain_car;
+    double checksum = 0;
+    mountain_car.reset();
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < n_steps; t++)
+    {
+        for (int i = 0; i < n_envs; i++)
+        {
+            mdp::StepResult<mdp::StaticState<2>> result = mountain_car.step(actions[i]);
+            checksum += result.next_state[0];
+            if (result.done) mountain_car.reset();
+        }
+    }
+    double single_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // single environment, without virtual calls nor copies of the results
+    mdp::StepResult<mdp::StaticState<2>> result;
+    mountain_car.reset();
+    start = chrono::steady_clock::now();
+    for (int t = 0; t < n_steps; t++)
+    {
+        for (int i = 0; i < n_envs; i++)
+        {
+            mountain_car.step_inline(actions[i], result);
+            checksum += result.next_state[0];
+            if (result.done) mountain_car.reset();
+        }
+    }
+    double inline_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // vectorized environment, with each kernel
+    double total_steps = ((double) n_envs)*n_steps;
+    cout << "MountainCar, " << n_envs << " environments" << endl;
+    cout << "    MountainCar::step:             " << total_steps/single_time/1e6 << " M steps/s" << endl;
+    cout << "    MountainCar::step_inline:      " << total_steps/inline_time/1e6 << " M steps/s" << endl;
+    for (bool use_simd : {false, true})
+    {
+        mdp::VecMountainCar env(n_envs, 42, 200);
+        env.use_simd = use_simd;
+        mdp::MountainCarStepBatch out;
+        start = chrono::steady_clock::now();
+        for (int t = 0; t < n_steps; t++)
+        {
+            env.step(actions.data(), out);
+            checksum += out.positions[0];
+        }
+        double vec_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "    VecMountainCar::step (" << env.instruction_set() << "): "
+             << total_steps/vec_time/1e6 << " M steps/s" << endl;
+    }
+    cout << "    (checksum " << checksum << ")" << endl;
+}
+
+int main(void)
+{
+    mdp::Chain chain(10, 0.1);
+    benchmark(chain, 1024, 10000);
+
+    mdp::GridWorld gridworld(20, 20, 0.2, 0.1);
+    benchmark(gridworld, 1024, 10000);
+
+    benchmark_mountain_car(1024, 10000);
+
+    return 0;
+}
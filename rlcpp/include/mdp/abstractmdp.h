@@ -19,7 +19,10 @@ template<typename S>
 class StepResult
 {
 public:
-    StepResult(); // default constructor
+    /**
+     * @brief Default constructor: value-initialized next state (-1 for integer states), zero reward, done = false.
+     */
+    StepResult();
     /**
      * @brief Initialize object with data
      * @param _next_state
@@ -46,11 +49,13 @@ public:
 };
 
 template<typename S>
-StepResult<S>::StepResult()
+StepResult<S>::StepResult(): next_state(), reward(0), done(false)
+{
+}
+
+template<>
+inline StepResult<int>::StepResult(): next_state(-1), reward(0), done(false)
 {
-    next_state = -1;
-    reward = 0;
-    done = false;
 }
 
 template<typename S>
@@ -68,6 +73,12 @@ template <typename S, typename A>
 class MDP
 {
 public:
+    /**
+     * Types of the states and of the actions
+     */
+    typedef S state_type;
+    typedef A action_type;
+
     MDP(/* args */) {};
     ~MDP() {};
 
@@ -85,6 +96,30 @@ public:
      */
     virtual StepResult<S> step(A action)=0;
 
+    /**
+     * @brief Take a step in the MDP, and store the result in out.
+     * @details Same as out = step(action), but reuses the memory of out (e.g., of out.next_state for vector
+     * states). The default implementation calls step().
+     * @param action
+     * @param out next state, reward and done flag
+     */
+    virtual void step_into(A action, StepResult<S>& out)
+    {
+        out = step(action);
+    }
+
+    /**
+     * @brief Take n consecutive steps, with one virtual call.
+     * @details The MDP is not reset when a terminal state is reached.
+     * @param actions array of n actions, taken in order
+     * @param n number of steps
+     * @param out array of n results, out[i] being the result of actions[i]
+     */
+    virtual void step_batch(const A* actions, int n, StepResult<S>* out)
+    {
+        for(int i = 0; i < n; i++) step_into(actions[i], out[i]);
+    }
+
     /**
      * Current state
      */
@@ -106,6 +141,52 @@ public:
     spaces::Space<A> action_space;
 
 };
+
+/**
+ * @brief Base class implementing the step functions of an MDP from a single non-virtual function.
+ * @details Curiously recurring template pattern: Derived must inherit from FastStep<Derived, Base> and define
+ *      void step_inline(action_type action, StepResult<state_type>& out);
+ * Then step(), step_into() and step_batch() are implemented with step_inline(). Code that knows the type of the
+ * environment (e.g., a function templated by it) can call step_inline() and step_batch_inline() directly, without
+ * virtual calls, so that the compiler can inline the steps in tight loops.
+ * @tparam Derived class of the environment
+ * @tparam Base MDP class from which the environment derives (MDP<S, A> or a subclass)
+ */
+template <class Derived, class Base>
+class FastStep: public Base
+{
+public:
+    typedef typename Base::state_type state_type;
+    typedef typename Base::action_type action_type;
+
+    StepResult<state_type> step(action_type action) override
+    {
+        StepResult<state_type> out;
+        derived().step_inline(action, out);
+        return out;
+    }
+
+    void step_into(action_type action, StepResult<state_type>& out) override
+    {
+        derived().step_inline(action, out);
+    }
+
+    void step_batch(const action_type* actions, int n, StepResult<state_type>* out) override
+    {
+        step_batch_inline(actions, n, out);
+    }
+
+    /**
+     * @brief Non-virtual version of step_batch().
+     */
+    void step_batch_inline(const action_type* actions, int n, StepResult<state_type>* out)
+    {
+        for(int i = 0; i < n; i++) derived().step_inline(actions[i], out[i]);
+    }
+
+private:
+    Derived& derived() { return static_cast<Derived&>(*this); }
+};
 }
 
-#endif
\ No newline at end of file
+#endif
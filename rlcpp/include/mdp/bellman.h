@@ -0,0 +1,87 @@
+#ifndef __BELLMAN_H__
+#define __BELLMAN_H__
+
+/**
+ * @file
+ * @brief Vectorized kernels for Bellman backups in finite MDPs.
+ */
+
+#include <string>
+#include "sparse_transitions.h"
+
+namespace mdp
+{
+    /**
+     * @brief Bellman backup kernels shared by the planning algorithms.
+     * @details The kernels use AVX-512 or AVX2 instructions when the processor supports them (detected at runtime),
+     * and a scalar implementation otherwise.
+     *
+     * The sparse kernels compute each term p*(r + v) with SIMD instructions but add the terms in the order of
+     * the entries, so their results are identical to the scalar loop. The count-weighted kernels use several
+     * accumulators and fused multiply-add, so their results may differ from the scalar loop by rounding errors.
+     */
+    namespace bellman
+    {
+        /**
+         * @brief Sparse count-weighted sum: sum over k of counts[k]*v[indices[k]].
+         * @details Used to compute expectations under empirical distributions without normalizing the counts.
+         * @param counts visit counts (array of size n)
+         * @param indices indices of the values, e.g. observed next states (array of size n)
+         * @param v values
+         * @param n number of elements
+         */
+        double weighted_sum(const int* counts, const int* indices, const double* v, int n);
+
+        /**
+         * @brief Sparse count-weighted first and second moments, in one pass.
+         * @details With x[k] = v[indices[k]] - shift, computes sum = sum over k of counts[k]*x[k] and
+         * sum_squares = sum over k of counts[k]*x[k]^2. Choosing shift close to the mean (e.g., one of the values)
+         * avoids the cancellation of sum_squares/N - (sum/N)^2 when computing the variance.
+         * @param counts visit counts (array of size n)
+         * @param indices indices of the values (array of size n)
+         * @param v values
+         * @param n number of elements
+         * @param shift value subtracted from v
+         * @param sum where the weighted sum is stored
+         * @param sum_squares where the weighted sum of squares is stored
+         */
+        void weighted_moments(const int* counts, const int* indices, const double* v, int n, double shift,
+                              double* sum, double* sum_squares);
+
+        /**
+         * @brief Sparse expected value: sum over k of p[k]*(r[k] + gamma*v[next_states[k]]).
+         * @param p transition probabilities (array of size n)
+         * @param r mean rewards (array of size n)
+         * @param next_states indices of the next states (array of size n)
+         * @param v value function, indexed by state
+         * @param n number of entries
+         * @param gamma discount factor
+         */
+        double expected_value(const double* p, const double* r, const int* next_states, const double* v, int n,
+                              double gamma = 1.0);
+
+        /**
+         * @brief Compute the values of all actions in state s, in one pass over the entries of s.
+         * @details q[a] = sum over s' of P(s'|s, a)*(R(s, a, s') + gamma*v[s'])
+         * @param P sparse transitions and mean rewards
+         * @param s state
+         * @param v value function of the next states, indexed by state
+         * @param q array of size P.na in which the action values are stored
+         * @param gamma discount factor
+         */
+        void backup_state(const SparseTransitions& P, int s, const double* v, double* q, double gamma = 1.0);
+
+        /**
+         * @brief Name of the instruction set used by the kernels: "avx512", "avx2" or "scalar".
+         */
+        std::string instruction_set();
+
+        /**
+         * @brief Enable or disable SIMD instructions (enabled by default if supported).
+         * @note Must not be called while a kernel is running in another thread.
+         */
+        void use_simd(bool enable);
+    }
+}
+
+#endif
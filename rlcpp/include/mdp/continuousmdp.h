@@ -2,6 +2,7 @@
 #define __CONTINUOUSMDP_H__
 
 #include <vector>
+#include <array>
 #include <assert.h>
 #include "abstractmdp.h"
 #include "utils.h"
@@ -60,6 +61,131 @@ namespace mdp
         */
         std::vector<double> state;
     };
+
+    /**
+     * @brief State of dimension D, stored without memory allocation.
+     */
+    template <int D>
+    using StaticState = std::array<double, D>;
+
+    /**
+     * @brief Class for continuous-state MDP with discrete actions, whose states have a dimension D known at compile
+     * time.
+     * @details States are of type StaticState<D>, so that reset() and step() do not allocate memory. Use
+     * DynamicContinuousMDP to get a ContinuousMDP (with states of type std::vector<double>) from such an MDP.
+     */
+    template <int D>
+    class StaticContinuousMDP: public MDP<StaticState<D>, int>
+    {
+    public:
+        StaticContinuousMDP() {}
+        ~StaticContinuousMDP() {};
+
+        virtual StaticState<D> reset() = 0;
+        virtual StepResult<StaticState<D>> step(int action) = 0;
+
+        /**
+         * Dimension of the states
+         */
+        static constexpr int dimension = D;
+
+        /**
+        * State (observation) space
+        */
+        spaces::Box observation_space;
+
+        /**
+        *  Action space
+        */
+        spaces::Discrete action_space;
+
+        /**
+        * For random number generation
+        */
+        utils::rand::Random randgen;
+
+        // Members of base class
+
+        /**
+         * Number of actions
+         */
+        int na;
+
+        /**
+        * MDP identifier
+        */
+        std::string id;
+
+        /**
+        * Current state
+        */
+        StaticState<D> state;
+    };
+
+    template <int D>
+    constexpr int StaticContinuousMDP<D>::dimension;
+
+    /**
+     * @brief ContinuousMDP running an environment whose states have a fixed dimension, for code using states of
+     * type std::vector<double>.
+     * @details The environment is stored in env, and its states are copied to state after each call to reset() and
+     * step(). The random numbers are drawn by env.randgen.
+     * @tparam Env default constructible class deriving from StaticContinuousMDP
+     */
+    template <class Env>
+    class DynamicContinuousMDP: public ContinuousMDP
+    {
+    public:
+        DynamicContinuousMDP()
+        {
+            observation_space = env.observation_space;
+            action_space = env.action_space;
+            na = env.na;
+            id = env.id;
+            set_state(env.state);
+        }
+
+        std::vector<double> reset()
+        {
+            set_state(env.reset());
+            return state;
+        }
+
+        StepResult<std::vector<double>> step(int action)
+        {
+            StepResult<StaticState<Env::dimension>> result = env.step(action);
+            set_state(result.next_state);
+            return StepResult<std::vector<double>>(state, result.reward, result.done);
+        }
+
+        void step_into(int action, StepResult<std::vector<double>>& out)
+        {
+            env.step_into(action, env_result);
+            set_state(env_result.next_state);
+            out.next_state.assign(state.begin(), state.end());
+            out.reward = env_result.reward;
+            out.done = env_result.done;
+        }
+
+        /**
+         * Environment with states of fixed dimension
+         */
+        Env env;
+
+    private:
+        /**
+         * Result of the last step of env
+         */
+        StepResult<StaticState<Env::dimension>> env_result;
+
+        /**
+         * @brief Copy a state of env to state, without allocating memory once state has the right size.
+         */
+        void set_state(const StaticState<Env::dimension>& _state)
+        {
+            state.assign(_state.begin(), _state.end());
+        }
+    };
 }
 
 #endif
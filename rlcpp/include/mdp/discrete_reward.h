@@ -22,6 +22,14 @@ namespace mdp
     {
  
     public:
+        /**
+         * Types of noise. Resolved from noise_type when the object is built, so that sampling does not compare strings.
+         */
+        enum NoiseType
+        {
+            none = 0, gaussian = 1
+        };
+
         /**
          * Default constructor
          */
@@ -30,26 +38,45 @@ namespace mdp
          * Create "reward without noise" object
          * @param _mean_rewards
          */
-        DiscreteReward(utils::vec::vec_3d _mean_rewards);
+        DiscreteReward(utils::vec::tensor_3d _mean_rewards);
+        /**
+         * Create "reward without noise" object from a nested vector
+         * @param _mean_rewards
+         */
+        DiscreteReward(const utils::vec::vec_3d& _mean_rewards);
         /**
          * Create "reward with noise" object
          * @param _mean_rewards
          * @param _noise_type 
          * @param _noise_params
          */
-        DiscreteReward(utils::vec::vec_3d _mean_rewards, std::string _noise_type, std::vector<double> _noise_params);
+        DiscreteReward(utils::vec::tensor_3d _mean_rewards, std::string _noise_type, std::vector<double> _noise_params);
+        /**
+         * Create "reward with noise" object from a nested vector
+         * @param _mean_rewards
+         * @param _noise_type 
+         * @param _noise_params
+         */
+        DiscreteReward(const utils::vec::vec_3d& _mean_rewards, std::string _noise_type, std::vector<double> _noise_params);
+        /**
+         * Create "noise only" object, used when the mean rewards are stored elsewhere (e.g., in mdp::SparseTransitions)
+         * @param _noise_type 
+         * @param _noise_params
+         */
+        DiscreteReward(std::string _noise_type, std::vector<double> _noise_params);
         ~DiscreteReward(){};
 
         /**
-        * 3d vector such that mean_rewards[s][a][s'] is the mean reward obtained when the
+        * 3d array such that mean_rewards(s, a, s') is the mean reward obtained when the
         * state s' is reached by taking action a in state s.
         */
-        utils::vec::vec_3d mean_rewards;
+        utils::vec::tensor_3d mean_rewards;
 
         /**
          * String describing the type of noise
          * "none": zero noise
          * "gaussian": zero-mean Gaussian distribution with variance given in noise_params
+         * @note Use set_noise() to change the noise after construction.
          */
         std::string noise_type;
 
@@ -59,14 +86,46 @@ namespace mdp
         */
         std::vector<double> noise_params;
 
+        /**
+         * Type of noise, corresponding to noise_type.
+         */
+        NoiseType noise;
+
+        /**
+         * Set the type and the parameters of the noise.
+         * @param _noise_type "none" or "gaussian"
+         * @param _noise_params
+         */
+        void set_noise(std::string _noise_type, std::vector<double> _noise_params);
+
         /**
          * Get a reward sample at (state, action, next_state)
          * @param state
          * @param action
          * @param next_state
+         * @param randgen random number generator for sampling the noise. It is advanced by the call.
+         * @note Throws std::logic_error if mean_rewards is empty, as in the reward function of a FiniteMDP, whose
+         * mean rewards are stored in its transitions.
+         */
+        double sample(int state, int action, int next_state, utils::rand::Random& randgen);
+
+        /**
+         * Get a sample of the noise only (zero if noise_type is "none")
+         * @param randgen random number generator for sampling the noise
+         */
+        double sample_noise(utils::rand::Random& randgen)
+        {
+            if (noise == none) return 0;
+            return randgen.sample_gaussian(0, noise_params[0]);
+        }
+
+        /**
+         * Add independent noise samples to an array of rewards (e.g., the mean rewards of many transitions).
+         * @param rewards array of size count, modified in place
+         * @param count number of rewards
          * @param randgen random number generator for sampling the noise
          */
-        double sample(int state, int action, int next_state, utils::rand::Random randgen);
+        void add_noise(double* rewards, int count, utils::rand::Random& randgen);
     };
 }
 
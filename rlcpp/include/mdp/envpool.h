@@ -0,0 +1,481 @@
+#ifndef __ENVPOOL_H__
+#define __ENVPOOL_H__
+
+/**
+ * @file
+ * @brief Pool of environments stepped asynchronously by worker threads.
+ */
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <string>
+#include <stdexcept>
+#include <iostream>
+#include <assert.h>
+#include "abstractmdp.h"
+#include "parallel.h"
+
+namespace mdp
+{
+    /**
+     * @brief Step (or reset) of an environment of an EnvPool, returned by EnvPool::recv().
+     */
+    template <typename S>
+    struct EnvStep
+    {
+        /**
+         * Index of the environment
+         */
+        int env = -1;
+
+        /**
+         * True if this is the result of a reset() of the pool, and not of an action.
+         */
+        bool reset = false;
+
+        /**
+         * Result of the step. For a reset, the initial state, a zero reward and done = false.
+         */
+        StepResult<S> result;
+
+        /**
+         * State from which the next action of the environment is taken: result.next_state, or the initial
+         * state of the next episode if the environment was reset because result.done is true.
+         */
+        S state;
+    };
+
+    /**
+     * @brief K environments, each owned by one worker thread, stepped asynchronously.
+     * @details Environment i is created (by the factory given to the constructor) and stepped only by the
+     * worker thread i % n_threads(), which can be pinned to a processor. The learner thread sends actions with
+     * send() and collects the results with recv(), in the order in which they complete: it can plan while
+     * the environments are being stepped, and slow environments do not delay the results of the fast ones.
+     *
+     * The actions and the results are passed through lock-free queues (utils::parallel::LockFreeQueue).
+     * A worker with no action to run, or a learner waiting in recv(), yields a few times and then sleeps on
+     * a condition variable until it is woken up by send() or by a worker.
+     *
+     * Each environment can have at most one pending action (or reset), i.e., an action whose result has not
+     * been returned by recv() yet: send() and reset() throw std::logic_error otherwise. send(), reset() and recv()
+     * must be called from a single thread.
+     *
+     * @tparam Env type of the environments: a subclass of mdp::MDP<S, A> (for instance GridWorld or
+     * MountainCar), or mdp::MDP<S, A> itself for environments of different types.
+     */
+    template <class Env>
+    class EnvPool
+    {
+    public:
+        typedef typename Env::state_type state_type;
+        typedef typename Env::action_type action_type;
+
+        /**
+         * @brief Function returning a new environment, given its index.
+         */
+        typedef std::function<std::shared_ptr<Env>(int)> EnvFactory;
+
+        /**
+         * @param make_env function creating environment i, called by the worker thread owning it
+         * @param n_envs number of environments
+         * @param n_threads number of worker threads, at most n_envs. If n_threads < 1, use
+         * std::thread::hardware_concurrency().
+         * @param auto_reset if true, an environment is reset by its worker when an episode ends (see EnvStep::state)
+         * @param pin_threads if true, worker thread t is restricted to the t-th processor on which the process may
+         * run (Linux only, see utils::parallel::pin_current_thread()). Failures are printed, see n_pinned_threads().
+         */
+        EnvPool(EnvFactory make_env, int n_envs, int n_threads = 0, bool auto_reset = true, bool pin_threads = false);
+
+        /**
+         * @brief Stop the worker threads. Pending actions are dropped.
+         */
+        ~EnvPool();
+
+        EnvPool(const EnvPool&) = delete;
+        EnvPool& operator=(const EnvPool&) = delete;
+
+        /**
+         * @brief Queue an action of environment env.
+         * @details Throws std::logic_error if env is not a valid index or already has a pending action.
+         */
+        void send(int env, action_type action);
+
+        /**
+         * @brief Queue the actions actions[k] of the environments envs[k], k = 0, ..., n-1.
+         * @details Each worker is woken up once, after all the actions are queued. If one of the actions is
+         * rejected (see send(int, action_type)), the previous ones are still sent and std::logic_error is thrown.
+         */
+        void send(const int* envs, const action_type* actions, int n);
+
+        /**
+         * @brief Queue a reset of environment env, which must not have a pending action.
+         */
+        void reset(int env);
+
+        /**
+         * @brief Queue a reset of all the environments, which must not have pending actions.
+         */
+        void reset();
+
+        /**
+         * @brief Move the completed steps to out, waiting until at least min_steps are available.
+         * @details out is cleared first. min_steps is capped to the number of pending actions, so that
+         * recv(out, size()) returns once all pending actions are completed.
+         * @param out completed steps, in order of completion
+         * @param min_steps minimum number of steps to return
+         * @return number of steps in out
+         */
+        int recv(std::vector<EnvStep<state_type>>& out, int min_steps = 1);
+
+        /**
+         * @brief Move one completed step to out, without waiting.
+         * @return false if no step is completed
+         */
+        bool try_recv(EnvStep<state_type>& out);
+
+        /**
+         * @brief Environment i. It must not be accessed while it has a pending action.
+         */
+        Env& get_env(int i) { return *envs[i]; }
+
+        /**
+         * @brief Number of environments
+         */
+        int size() const { return (int) envs.size(); }
+
+        /**
+         * @brief Number of worker threads
+         */
+        int n_threads() const { return (int) workers.size(); }
+
+        /**
+         * @brief Number of actions (and resets) sent whose results were not returned by recv() yet.
+         */
+        int n_pending() const { return pending_count; }
+
+        /**
+         * @brief Number of worker threads that were successfully pinned to a processor.
+         */
+        int n_pinned_threads() const { return n_pinned; }
+
+    private:
+        /**
+         * Action (or reset) of an environment, sent to its worker.
+         */
+        struct Command
+        {
+            int env = -1;
+            bool reset = false;
+            action_type action = action_type();
+        };
+
+        struct Worker
+        {
+            Worker(int capacity): commands(capacity), sleeping(false) {}
+            utils::parallel::LockFreeQueue<Command> commands;
+            std::mutex mutex;
+            std::condition_variable wake_cv;
+            std::atomic<bool> sleeping;
+            std::thread thread;
+        };
+
+        /**
+         * @brief Loop run by worker thread id.
+         */
+        void worker_loop(int id, const EnvFactory& make_env);
+
+        /**
+         * @brief Run a command in the worker thread, and store its result in step.
+         */
+        void run(const Command& command, EnvStep<state_type>& step);
+
+        /**
+         * @brief Push a command to the queue of the worker of its environment, without waking up the worker.
+         */
+        void enqueue(const Command& command);
+
+        /**
+         * @brief Wake up worker id if it is sleeping.
+         */
+        void wake(int id);
+
+        /**
+         * @brief Sleep until queue is not empty or the pool stops, after yielding a few times.
+         * @param sleeping flag telling the threads filling queue that the caller must be woken up
+         */
+        template <class Queue>
+        void wait_for(const Queue& queue, std::atomic<bool>& sleeping, std::mutex& mutex,
+                      std::condition_variable& cv);
+
+        std::vector<std::shared_ptr<Env>> envs;
+        std::vector<std::unique_ptr<Worker>> workers;
+        bool auto_reset;
+
+        /**
+         * Completed steps, filled by the workers and emptied by the learner.
+         */
+        utils::parallel::LockFreeQueue<EnvStep<state_type>> completed;
+        std::mutex learner_mutex;
+        std::condition_variable learner_cv;
+        std::atomic<bool> learner_sleeping;
+
+        /**
+         * Number of workers still creating their environments, protected by learner_mutex.
+         */
+        int n_starting;
+        std::atomic<bool> stopping;
+
+        /**
+         * Number of pinned worker threads, protected by learner_mutex until the workers are started.
+         */
+        int n_pinned = 0;
+
+        /**
+         * Used by the learner thread only: pending[i] is 1 if environment i has a pending action.
+         */
+        std::vector<unsigned char> pending;
+        int pending_count = 0;
+    };
+
+    template <class Env>
+    EnvPool<Env>::EnvPool(EnvFactory make_env, int n_envs, int n_threads /* = 0 */, bool auto_reset /* = true */,
+                          bool pin_threads /* = false */):
+        envs(n_envs), auto_reset(auto_reset), completed(n_envs), learner_sleeping(false), stopping(false),
+        pending(n_envs, 0)
+    {
+        assert(n_envs > 0 && "EnvPool requires at least one environment");
+        if (n_threads < 1) n_threads = std::thread::hardware_concurrency();
+        n_threads = std::max(1, std::min(n_threads, n_envs));
+        n_starting = n_threads;
+        for(int id = 0; id < n_threads; id++)
+        {
+            workers.push_back(std::unique_ptr<Worker>(new Worker((n_envs + n_threads - 1)/n_threads)));
+        }
+        for(int id = 0; id < n_threads; id++)
+        {
+            workers[id]->thread = std::thread([this, id, pin_threads, &make_env]()
+            {
+                if (pin_threads)
+                {
+                    bool pinned = utils::parallel::pin_current_thread(id);
+                    std::lock_guard<std::mutex> lock(learner_mutex);
+                    if (pinned) n_pinned++;
+                    else std::cerr << "EnvPool: worker thread " << id << " could not be pinned" << std::endl;
+                }
+                worker_loop(id, make_env);
+            });
+        }
+        // wait until the environments are created, since make_env is a reference to an argument
+        std::unique_lock<std::mutex> lock(learner_mutex);
+        learner_cv.wait(lock, [this] { return n_starting == 0; });
+    }
+
+    template <class Env>
+    EnvPool<Env>::~EnvPool()
+    {
+        stopping.store(true);
+        for(std::unique_ptr<Worker>& worker: workers)
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->wake_cv.notify_one();
+        }
+        for(std::unique_ptr<Worker>& worker: workers) worker->thread.join();
+    }
+
+    template <class Env>
+    void EnvPool<Env>::send(int env, action_type action)
+    {
+        Command command;
+        command.env = env;
+        command.action = action;
+        enqueue(command);
+        wake(env % n_threads());
+    }
+
+    template <class Env>
+    void EnvPool<Env>::send(const int* _envs, const action_type* actions, int n)
+    {
+        Command command;
+        try
+        {
+            for(int k = 0; k < n; k++)
+            {
+                command.env = _envs[k];
+                command.action = actions[k];
+                enqueue(command);
+            }
+        }
+        catch (...)
+        {
+            for(int id = 0; id < n_threads(); id++) wake(id);
+            throw;
+        }
+        for(int id = 0; id < n_threads(); id++) wake(id);
+    }
+
+    template <class Env>
+    void EnvPool<Env>::reset(int env)
+    {
+        Command command;
+        command.env = env;
+        command.reset = true;
+        enqueue(command);
+        wake(env % n_threads());
+    }
+
+    template <class Env>
+    void EnvPool<Env>::reset()
+    {
+        for(int i = 0; i < size(); i++)
+        {
+            if (pending[i]) throw std::logic_error("EnvPool::reset(): environment " + std::to_string(i)
+                                                   + " has a pending action");
+        }
+        Command command;
+        command.reset = true;
+        for(int i = 0; i < size(); i++)
+        {
+            command.env = i;
+            enqueue(command);
+        }
+        for(int id = 0; id < n_threads(); id++) wake(id);
+    }
+
+    template <class Env>
+    int EnvPool<Env>::recv(std::vector<EnvStep<state_type>>& out, int min_steps /* = 1 */)
+    {
+        out.clear();
+        min_steps = std::min(min_steps, pending_count);
+        EnvStep<state_type> step;
+        while (true)
+        {
+            while (try_recv(step)) out.push_back(std::move(step));
+            if ((int) out.size() >= min_steps) return out.size();
+            wait_for(completed, learner_sleeping, learner_mutex, learner_cv);
+        }
+    }
+
+    template <class Env>
+    bool EnvPool<Env>::try_recv(EnvStep<state_type>& out)
+    {
+        if (!completed.pop(out)) return false;
+        pending[out.env] = 0;
+        pending_count--;
+        return true;
+    }
+
+    template <class Env>
+    void EnvPool<Env>::enqueue(const Command& command)
+    {
+        if (command.env < 0 || command.env >= size())
+        {
+            throw std::logic_error("EnvPool: invalid environment index " + std::to_string(command.env));
+        }
+        if (pending[command.env])
+        {
+            throw std::logic_error("EnvPool: environment " + std::to_string(command.env)
+                                   + " already has a pending action");
+        }
+        // cannot fail: a worker has at most one pending command per environment
+        Command copy = command;
+        if (!workers[command.env % n_threads()]->commands.push(std::move(copy)))
+        {
+            throw std::logic_error("EnvPool: the queue of the worker of environment "
+                                   + std::to_string(command.env) + " is full");
+        }
+        pending[command.env] = 1;
+        pending_count++;
+    }
+
+    template <class Env>
+    void EnvPool<Env>::wake(int id)
+    {
+        Worker& worker = *workers[id];
+        // either the worker sees the new command before sleeping, or we see that it sleeps
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (worker.sleeping.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.wake_cv.notify_one();
+        }
+    }
+
+    template <class Env>
+    template <class Queue>
+    void EnvPool<Env>::wait_for(const Queue& queue, std::atomic<bool>& sleeping, std::mutex& mutex,
+                                std::condition_variable& cv)
+    {
+        for(int k = 0; k < 16; k++)
+        {
+            if (!queue.empty() || stopping.load(std::memory_order_relaxed)) return;
+            std::this_thread::yield();
+        }
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (queue.empty())
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return !queue.empty() || stopping.load(); });
+        }
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    template <class Env>
+    void EnvPool<Env>::worker_loop(int id, const EnvFactory& make_env)
+    {
+        for(int i = id; i < size(); i += n_threads()) envs[i] = make_env(i);
+        {
+            std::lock_guard<std::mutex> lock(learner_mutex);
+            if (--n_starting == 0) learner_cv.notify_all();
+        }
+
+        Worker& worker = *workers[id];
+        Command command;
+        EnvStep<state_type> step;
+        while (!stopping.load(std::memory_order_relaxed))
+        {
+            if (!worker.commands.pop(command))
+            {
+                wait_for(worker.commands, worker.sleeping, worker.mutex, worker.wake_cv);
+                continue;
+            }
+            run(command, step);
+            // never waits: there is at most one pending command per environment, so completed cannot be full
+            while (!completed.push(std::move(step))) std::this_thread::yield();
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (learner_sleeping.load(std::memory_order_relaxed))
+            {
+                std::lock_guard<std::mutex> lock(learner_mutex);
+                learner_cv.notify_one();
+            }
+        }
+    }
+
+    template <class Env>
+    void EnvPool<Env>::run(const Command& command, EnvStep<state_type>& step)
+    {
+        Env& env = *envs[command.env];
+        step.env = command.env;
+        step.reset = command.reset;
+        if (command.reset)
+        {
+            step.state = env.reset();
+            step.result.next_state = step.state;
+            step.result.reward = 0;
+            step.result.done = false;
+            return;
+        }
+        env.step_into(command.action, step.result);
+        if (step.result.done && auto_reset) step.state = env.reset();
+        else step.state = step.result.next_state;
+    }
+}
+
+#endif
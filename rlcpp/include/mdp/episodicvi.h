@@ -1,16 +1,20 @@
 #ifndef __EPISODICVI_H__
 #define __EPISODICVI_H__
 
+#include <memory>
 #include "abstractmdp.h"
 #include "finitemdp.h"
 #include "chain.h"
 #include "space.h"
 #include "history.h"
+#include "parallel.h"
 
 namespace mdp
 {
     /**
      * @brief Class to run episodic value iteration in a finite MDP.
+     * @details At each stage h, the backups of the different states are independent, and can be computed by
+     * several threads (see set_num_threads()). The results do not depend on the number of threads.
      */
     class EpisodicVI
     {
@@ -32,8 +36,28 @@ namespace mdp
              * @param pi vector of integers of dimensions (horizon x ns). 
              * @param Vpi vector of doubles, filled with zeros, of dimensions (horizon+1, ns), in which the result is stored.
              */
-            void evaluate_policy(utils::vec::ivec_2d pi, utils::vec::vec_2d& Vpi);
+            void evaluate_policy(const utils::vec::ivec_2d& pi, utils::vec::vec_2d& Vpi);
+
+            /**
+             * @brief Set the number of threads used by run() and evaluate_policy().
+             * @param n_threads number of threads. If n_threads < 1, use all available cores. Default = 1.
+             * @param schedule how the states are distributed among threads at each stage
+             * @param chunk_size number of states per chunk for utils::parallel::dynamic_schedule (0 = automatic)
+             */
+            void set_num_threads(int n_threads,
+                                 utils::parallel::schedule_type schedule = utils::parallel::static_schedule,
+                                 int chunk_size = 0);
         protected:
+            /**
+             * @brief Compute Q[h][s][a], V[h][s] and greedy_policy[h][s] for s in [s_begin, s_end).
+             */
+            void backup_states(int h, int s_begin, int s_end);
+
+            /**
+             * @brief Compute Vpi[h][s] for s in [s_begin, s_end).
+             */
+            void evaluate_states(const utils::vec::ivec_2d& pi, utils::vec::vec_2d& Vpi, int h, int s_begin, int s_end);
+
             /**
              * MDP object.
              */
@@ -43,6 +67,20 @@ namespace mdp
              */
             int horizon;
 
+            /**
+             * Threads used in run() and evaluate_policy(). Null if a single thread is used.
+             * Shared by the copies of this object.
+             */
+            std::shared_ptr<utils::parallel::ThreadPool> pool;
+            /**
+             * Distribution of the states among threads.
+             */
+            utils::parallel::schedule_type schedule;
+            /**
+             * Number of states per chunk for dynamic scheduling.
+             */
+            int chunk_size;
+
         public:
             /**
              * Greedy policy, stored as a vector of integers of dimensions (horizon x ns)
@@ -56,7 +94,7 @@ namespace mdp
             /**
              * Q function. Dimensions (horizon+1 x ns x na).
              */ 
-            utils::vec::vec_3d Q;
+            utils::vec::tensor_3d Q;
     };
 }
 
@@ -13,34 +13,56 @@
 #include "utils.h"
 #include "history.h"
 #include "discrete_reward.h"
+#include "sparse_transitions.h"
 
 
 namespace mdp
 {
     /**
      * Base class for Finite Markov Decision Processes.
+     * @details Transitions and mean rewards are stored in a mdp::SparseTransitions object. Dense arrays given to the
+     * constructors are converted to this format, and only the noise model is kept in reward_function.
      */ 
-    class FiniteMDP: public MDP<int, int>
+    class FiniteMDP: public FastStep<FiniteMDP, MDP<int, int>>
     {
 
     public:
         /**
          * @param _reward_function object of type DiscreteReward representing the reward function
-         * @param _transitions
+         * @param _transitions 3d array of dimensions (S, A, S). A nested utils::vec::vec_3d is converted implicitly.
          * @param _default_state index of the default state
          * @param _seed random seed
          */
-        FiniteMDP(DiscreteReward _reward_function, utils::vec::vec_3d _transitions, int _default_state = 0, int _seed = -1);
+        FiniteMDP(DiscreteReward _reward_function, utils::vec::tensor_3d _transitions, int _default_state = 0, int _seed = -1);
 
 
         /**
          * @param _reward_function object of type DiscreteReward representing the reward function
-         * @param _transitions
+         * @param _transitions 3d array of dimensions (S, A, S). A nested utils::vec::vec_3d is converted implicitly.
          * @param _terminal_states vector containing the indices of the terminal states
          * @param _default_state index of the default state
          * @param _seed random seed
          */
-        FiniteMDP(DiscreteReward _reward_function, utils::vec::vec_3d _transitions, std::vector<int> _terminal_states, int _default_state = 0, int _seed = -1);
+        FiniteMDP(DiscreteReward _reward_function, utils::vec::tensor_3d _transitions, std::vector<int> _terminal_states, int _default_state = 0, int _seed = -1);
+
+        /**
+         * @param _reward_function object of type DiscreteReward representing the reward noise. Its mean_rewards must be empty
+         * (std::invalid_argument is thrown otherwise).
+         * @param _transitions sparse transitions and mean rewards
+         * @param _default_state index of the default state
+         * @param _seed random seed
+         */
+        FiniteMDP(DiscreteReward _reward_function, SparseTransitions _transitions, int _default_state = 0, int _seed = -1);
+
+        /**
+         * @param _reward_function object of type DiscreteReward representing the reward noise. Its mean_rewards must be empty
+         * (std::invalid_argument is thrown otherwise).
+         * @param _transitions sparse transitions and mean rewards
+         * @param _terminal_states vector containing the indices of the terminal states
+         * @param _default_state index of the default state
+         * @param _seed random seed
+         */
+        FiniteMDP(DiscreteReward _reward_function, SparseTransitions _transitions, std::vector<int> _terminal_states, int _default_state = 0, int _seed = -1);
 
         ~FiniteMDP(){};
 
@@ -51,24 +73,33 @@ namespace mdp
         int reset();
 
         /**
-         * @brief take a step in the MDP
+         * @brief Take a step in the MDP, and store the next state, the reward and the 'done' flag in out.
+         * @details Non-virtual: step(), step_into() and step_batch() call this function, see FastStep.
+         * The 'done' flag is true if the next state is terminal.
          * @param action action to take
-         * @return StepResult object, contaning next state, reward and 'done' flag
+         * @param out result of the step
          */
-        StepResult<int> step(int action);
+        inline void step_inline(int action, StepResult<int>& out);
 
         /**
          * @brief Check if _state is terminal
+         * @details Constant time lookup in terminal_mask.
          * @param _state
          * @return true if _state is terminal, false otherwise
          */
-        bool is_terminal(int _state);
+        bool is_terminal(int _state) const { return terminal_mask[_state] != 0; }
+
+        /**
+         * @brief Set the terminal states and update terminal_mask.
+         * @param _terminal_states vector containing the indices of the terminal states
+         */
+        void set_terminal_states(std::vector<int> _terminal_states);
 
         /**
          * Set the seed of randgen and seed of action space and observation space
          * The seed of randgen is set to _seed, the seed of action space is set to _seed+123
          * and the seed of observation space is set to _seed+456
-         * Note: If _seed < 1,  we set _seed = std::rand()
+         * Note: If _seed < 1,  we set _seed = utils::rand::default_seed()
          * @param _seed
          */
         void set_seed(int _seed); 
@@ -79,6 +110,24 @@ namespace mdp
          */
         utils::rand::Random randgen;
 
+        /**
+         * Alias tables of the rows of transitions, used to sample next states in O(1).
+         * Entry k of row (s, a) is transitions.next_states()[k], as in transitions.
+         */
+        std::vector<double> alias_prob;
+        std::vector<int> alias_index;
+
+        /**
+         * Stamp of the transitions from which the alias tables were built.
+         */
+        unsigned long alias_stamp = 0;
+
+        /**
+         * @brief Build the alias tables of all rows of transitions.
+         * @details Called by set_params(), and by step_inline() if the transitions were modified after set_params().
+         */
+        void build_alias_tables();
+
     protected:
         /**
          * @brief Default constructor. Returns a undefined MDP.
@@ -88,21 +137,42 @@ namespace mdp
         /**
          * @brief Constructor *without* terminal states.
          * @param _reward_function object of type DiscreteReward representing the reward function
-         * @param _transitions
+         * @param _transitions 3d array of dimensions (S, A, S). A nested utils::vec::vec_3d is converted implicitly.
          * @param _default_state index of the default state
-         * @param _seed random seed. If seed < 1, a random seed is selected by calling std::rand().
+         * @param _seed random seed. If seed < 1, a seed is selected by calling utils::rand::default_seed().
          */
-        void set_params(DiscreteReward _reward_function, utils::vec::vec_3d _transitions, int _default_state = 0, int _seed = -1);
+        void set_params(DiscreteReward _reward_function, utils::vec::tensor_3d _transitions, int _default_state = 0, int _seed = -1);
 
         /**
          * @brief Constructor *with* terminal states.
          * @param _reward_function object of type DiscreteReward representing the reward function
-         * @param _transitions
+         * @param _transitions 3d array of dimensions (S, A, S). A nested utils::vec::vec_3d is converted implicitly.
          * @param _terminal_states vector containing the indices of the terminal states
          * @param _default_state index of the default state
-         * @param _seed random seed. If seed < 1, a random seed is selected by calling std::rand().
+         * @param _seed random seed. If seed < 1, a seed is selected by calling utils::rand::default_seed().
+         */
+        void set_params(DiscreteReward _reward_function, utils::vec::tensor_3d _transitions, std::vector<int> _terminal_states, int _default_state = 0, int _seed = -1);
+
+        /**
+         * @brief Constructor from sparse transitions, *without* terminal states.
+         * @param _reward_function object of type DiscreteReward representing the reward noise. Its mean_rewards must be empty
+         * (std::invalid_argument is thrown otherwise).
+         * @param _transitions sparse transitions and mean rewards
+         * @param _default_state index of the default state
+         * @param _seed random seed. If seed < 1, a seed is selected by calling utils::rand::default_seed().
          */
-        void set_params(DiscreteReward _reward_function, utils::vec::vec_3d _transitions, std::vector<int> _terminal_states, int _default_state = 0, int _seed = -1);
+        void set_params(DiscreteReward _reward_function, SparseTransitions _transitions, int _default_state = 0, int _seed = -1);
+
+        /**
+         * @brief Constructor from sparse transitions, *with* terminal states.
+         * @param _reward_function object of type DiscreteReward representing the reward noise. Its mean_rewards must be empty
+         * (std::invalid_argument is thrown otherwise).
+         * @param _transitions sparse transitions and mean rewards
+         * @param _terminal_states vector containing the indices of the terminal states
+         * @param _default_state index of the default state
+         * @param _seed random seed. If seed < 1, a seed is selected by calling utils::rand::default_seed().
+         */
+        void set_params(DiscreteReward _reward_function, SparseTransitions _transitions, std::vector<int> _terminal_states, int _default_state = 0, int _seed = -1);
 
         /**
          * @brief check if attributes are well defined.
@@ -110,15 +180,15 @@ namespace mdp
         void check();
     public:
         /**
-         * DiscreteReward representing the reward function.
+         * DiscreteReward representing the reward noise. The mean rewards are stored in transitions.
          */
         DiscreteReward reward_function;
 
         /**
-         * 3d vector such that transitions[s][a][s'] is the probability of reaching
-         * state s' by taking action a in state s.
+         * Sparse transitions: for each (s, a), the next states s' reachable with positive probability,
+         * the probability of reaching them and the mean reward of (s, a, s').
          */
-        utils::vec::vec_3d transitions;
+        SparseTransitions transitions;
 
         /**
          * Default state
@@ -137,9 +207,15 @@ namespace mdp
 
         /**
          * Vector of terminal states
+         * @note Use set_terminal_states() to modify it, so that terminal_mask is kept up to date.
          */
         std::vector<int> terminal_states;
 
+        /**
+         * Vector of size ns such that terminal_mask[s] is 1 if s is terminal and 0 otherwise.
+         */
+        std::vector<unsigned char> terminal_mask;
+
         /**
          * State (observation) space
          */
@@ -167,5 +243,20 @@ namespace mdp
          */
         std::string id;
     };
+
+    void FiniteMDP::step_inline(int action, StepResult<int>& out)
+    {
+        // Rebuild samplers if transitions were modified
+        if (alias_stamp != transitions.stamp()) build_alias_tables();
+
+        // Sample next state
+        int begin = transitions.row_begin(state, action);
+        int n = transitions.row_end(state, action) - begin;
+        int k = begin + randgen.sample_alias(alias_prob.data() + begin, alias_index.data() + begin, n);
+        out.next_state = transitions.next_states()[k];
+        out.reward = transitions.rewards()[k] + reward_function.sample_noise(randgen);
+        out.done = is_terminal(out.next_state);
+        state = out.next_state;
+    }
 }
 #endif
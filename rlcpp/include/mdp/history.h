@@ -77,6 +77,13 @@ namespace mdp
          */
         void to_csv(std::string filename);
 
+        /**
+         * @brief Write binary columnar file with history, much faster to write and to read than a csv file.
+         * @details See historyfile.h for the format, and mdp::HistoryReader to read the file.
+         * @param filename example: "myfile.bin"
+         */
+        void to_binary(std::string filename);
+
         /**
          * @brief clear all stored data
          */
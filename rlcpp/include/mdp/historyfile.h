@@ -0,0 +1,159 @@
+#ifndef __HISTORYFILE_H__
+#define __HISTORYFILE_H__
+
+/**
+ * @file
+ * @brief Binary columnar files storing a History<int, int>, and conversion to csv.
+ * @details A file written by History<int, int>::to_binary() contains, in the byte order of the machine that wrote it:
+ *  - a header: the magic string "RLCPPHST" (8 bytes), the version (uint32), the number of columns (uint32) and
+ *    the length of the history (uint64);
+ *  - the schema: for each column, its type (uint32: 0 for int32, 1 for float64), the length of its name (uint32),
+ *    the offset of its data from the beginning of the file (uint64) and its name;
+ *  - the columns: the arrays episode, state, action, next_state (int32), reward (float64) and the extra
+ *    variables (float64), each of them contiguous and starting at an offset multiple of 64 bytes.
+ */
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "history.h"
+#include "utils.h"
+
+namespace mdp
+{
+    /**
+     * @brief Read-only view of the columns of a History<int, int>.
+     */
+    struct HistoryView
+    {
+        /**
+         * @brief View of the arrays of history, which must not be modified while the view is used.
+         */
+        static HistoryView of(const History<int, int>& history);
+
+        /**
+         * @brief Number of steps
+         */
+        std::size_t length() const { return rewards.size(); }
+
+        utils::Span<const int> episodes;
+        utils::Span<const int> states;
+        utils::Span<const int> actions;
+        utils::Span<const int> next_states;
+        utils::Span<const double> rewards;
+
+        /**
+         * Names and values of the extra variables
+         */
+        std::vector<std::string> extra_names;
+        std::vector<utils::Span<const double>> extra_variables;
+    };
+
+    /**
+     * @brief Write history to a binary file (see historyfile.h for the format).
+     * @return false if the file could not be written
+     */
+    bool write_history_binary(const HistoryView& history, std::string filename);
+
+    /**
+     * @brief Write history to a csv file, in the format of History<int, int>::to_csv().
+     * @details The values are formatted into a buffer written in large blocks, as std::ostream would format them
+     * with its default settings (6 significant digits for the doubles).
+     * @return false if the file could not be written
+     */
+    bool write_history_csv(const HistoryView& history, std::string filename);
+
+    /**
+     * @brief Reader of the binary files written by History<int, int>::to_binary().
+     * @details The file is mapped in memory (with mmap, on POSIX systems) and the columns are returned as spans
+     * pointing to the mapping, so that nothing is copied: the pages are only read from the disk when they are
+     * accessed. On other systems, the file is read into memory.
+     */
+    class HistoryReader
+    {
+    public:
+        /**
+         * @param filename file written by History<int, int>::to_binary(). If it cannot be read or is not valid,
+         * an error is printed and is_open() is false.
+         */
+        HistoryReader(std::string filename);
+        ~HistoryReader();
+
+        HistoryReader(const HistoryReader&) = delete;
+        HistoryReader& operator=(const HistoryReader&) = delete;
+
+        /**
+         * @brief true if the file was read successfully
+         */
+        bool is_open() const { return data != nullptr; }
+
+        /**
+         * @brief Number of steps
+         */
+        std::size_t length() const { return columns.length(); }
+
+        /**
+         * @brief Number of extra variables
+         */
+        int n_extra_variables() const { return columns.extra_variables.size(); }
+
+        utils::Span<const int> episodes() const { return columns.episodes; }
+        utils::Span<const int> states() const { return columns.states; }
+        utils::Span<const int> actions() const { return columns.actions; }
+        utils::Span<const int> next_states() const { return columns.next_states; }
+        utils::Span<const double> rewards() const { return columns.rewards; }
+
+        /**
+         * @brief Values of the extra variable j
+         */
+        utils::Span<const double> extra_variable(int j) const { return columns.extra_variables[j]; }
+
+        /**
+         * @brief Name of the extra variable j
+         */
+        const std::string& extra_name(int j) const { return columns.extra_names[j]; }
+
+        /**
+         * @brief All the columns. The spans are valid as long as the reader exists.
+         */
+        const HistoryView& view() const { return columns; }
+
+        /**
+         * @brief Write the history to a csv file, in the format of History<int, int>::to_csv().
+         * @return false if the file could not be written
+         */
+        bool to_csv(std::string filename) const;
+
+        /**
+         * @brief Copy the history to a History<int, int> object, replacing its content.
+         */
+        void to_history(History<int, int>& history) const;
+
+    private:
+        /**
+         * @brief Check the header and the schema of the file, and set columns.
+         */
+        bool parse(const std::string& filename);
+
+        /**
+         * @brief Unmap the file, or free its copy.
+         */
+        void close();
+
+        /**
+         * Content of the file, of size size
+         */
+        const char* data = nullptr;
+        std::size_t size = 0;
+
+        /**
+         * true if data is a mapping of the file, false if it points to buffer.
+         */
+        bool mapped = false;
+        std::vector<char> buffer;
+
+        HistoryView columns;
+    };
+}
+
+#endif
@@ -9,7 +9,15 @@
 #include "mountaincar.h"
 #include "gridworld.h"
 #include "episodicvi.h"
+#include "valueiteration.h"
+#include "policyiteration.h"
 #include "discrete_reward.h"
+#include "sparse_transitions.h"
+#include "vecfinitemdp.h"
+#include "vecmountaincar.h"
+#include "historyfile.h"
+#include "envpool.h"
+#include "bellman.h"
 
 /**
  * @file 
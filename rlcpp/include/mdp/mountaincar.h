@@ -2,6 +2,7 @@
 #define __MOUNTAINCAR_H__
 
 #include <vector>
+#include <cmath>
 #include <assert.h>
 #include "abstractmdp.h"
 #include "continuousmdp.h"
@@ -27,9 +28,15 @@ namespace mdp
      * 
      *   The terminal state is (goal_position, goal_velocity)
      * 
-     *   A reward of 0 is obtained everywhere, except for the terminal state, where the reward is 1.
+     *   A reward of 0 is obtained everywhere, except for the terminal state, where the reward is 1. The reward
+     *   and the 'done' flag of a step are those of the state reached by the step.
+     *
+     *   The velocity is set to 0 when the car hits the left wall (position -1.2) with a negative velocity.
+     *
+     *   The states are of type StaticState<2>, so that steps do not allocate memory. Use
+     *   DynamicContinuousMDP<MountainCar> to get states of type std::vector<double>.
      */
-    class MountainCar: public ContinuousMDP
+    class MountainCar: public FastStep<MountainCar, StaticContinuousMDP<2>>
     {
     public:
         /**
@@ -41,14 +48,19 @@ namespace mdp
         };
 
         MountainCar();
-        std::vector<double> reset();
-        StepResult<std::vector<double>> step(int action);
+        StaticState<2> reset();
+
+        /**
+         * @brief Take a step, and store the next state, the reward and the 'done' flag in out.
+         * @details Non-virtual: step(), step_into() and step_batch() call this function, see FastStep.
+         */
+        inline void step_inline(int action, StepResult<StaticState<2>>& out);
 
     protected:
         /**
          * @brief Returns true if the state is terminal.
          */
-        bool is_terminal(std::vector<double> state);
+        bool is_terminal(const StaticState<2>& _state) const;
         /**
          * Position at the terminal state
          */
@@ -69,6 +81,30 @@ namespace mdp
         static constexpr double gravity = 0.0025;
 
     };
+
+    void MountainCar::step_inline(int action, StepResult<StaticState<2>>& out)
+    {
+        assert(action_space.contains(action));
+
+        const std::vector<double>& lo = observation_space.low;
+        const std::vector<double>& hi = observation_space.high;
+
+        double p = state[position];
+        double v = state[velocity];
+
+        v += (action-1)*force + std::cos(3*p)*(-gravity);
+        v = utils::clamp(v, lo[velocity], hi[velocity]);
+        p += v;
+        p = utils::clamp(p, lo[position], hi[position]);
+        if ((std::abs(p-lo[position])<1e-10) && (v<0)) v = 0;
+
+        state[position] = p;
+        state[velocity] = v;
+
+        out.next_state = state;
+        out.done = is_terminal(state);
+        out.reward = out.done ? 1.0 : 0.0;
+    }
 }
 
 #endif
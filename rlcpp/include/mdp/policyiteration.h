@@ -0,0 +1,177 @@
+#ifndef __POLICYITERATION_H__
+#define __POLICYITERATION_H__
+
+#include <vector>
+#include "finitemdp.h"
+#include "utils.h"
+
+namespace mdp
+{
+    /**
+     * @brief Linear solver used by PolicyIteration to evaluate a policy pi, i.e. to solve (I - gamma P_pi) V = r_pi.
+     * - gauss_seidel_solver: in-place sweeps, each state solving its own equation given the others.
+     * - sor_solver: successive over-relaxation, Gauss-Seidel sweeps extrapolated by a factor omega.
+     * - bicgstab_solver: BiCGSTAB, a Krylov method in the family of conjugate gradient for non-symmetric systems.
+     */
+    enum evaluation_solver {gauss_seidel_solver, sor_solver, bicgstab_solver};
+
+    /**
+     * @brief Class to run policy iteration for the discounted, infinite-horizon criterion in a finite MDP.
+     * @details Each iteration evaluates the current policy pi, then makes it greedy with respect to its value.
+     *
+     * If evaluation_sweeps = 0, each policy is evaluated up to the precision tolerance by the chosen solver, and the
+     * algorithm stops when the policy no longer changes.
+     *
+     * If evaluation_sweeps = k > 0, modified policy iteration is run instead: each policy is evaluated by applying
+     * k times its Bellman operator to the current V, and the algorithm stops when the span of the change of V
+     * due to the greedy step is smaller than tolerance*(1-gamma)/gamma.
+     */
+    class PolicyIteration
+    {
+        public:
+            /**
+             * @param mdp FiniteMDP object
+             * @param gamma discount factor, in [0, 1)
+             * @param tolerance precision of the policy evaluation (bound on |V - Vpi|)
+             * @param max_iterations maximum number of policy improvements
+             */
+            PolicyIteration(FiniteMDP& mdp, double gamma, double tolerance = 1e-8, int max_iterations = 1000);
+
+            /**
+             * @brief Run policy iteration, starting from policy (or from action 0 in every state if policy is
+             * empty or has the wrong size).
+             * @details Store results in policy and V.
+             */
+            void run();
+
+            /**
+             * @brief Compute the value of a policy with the chosen solver.
+             * @param pi action of each state. Size ns.
+             * @param Vpi initial guess, of size ns, in which the result is stored.
+             * @return number of solver iterations
+             */
+            int evaluate_policy(const std::vector<int>& pi, std::vector<double>& Vpi);
+
+        protected:
+            /**
+             * @brief Store r_pi and the diagonal of P_pi for the policy pi.
+             */
+            void set_policy(const std::vector<int>& pi);
+
+            /**
+             * @brief Gauss-Seidel (omega = 1) or SOR evaluation of the current policy.
+             */
+            int evaluate_sor(std::vector<double>& Vpi, double omega);
+
+            /**
+             * @brief BiCGSTAB evaluation of the current policy.
+             */
+            int evaluate_bicgstab(std::vector<double>& Vpi);
+
+            /**
+             * @brief Apply k times the Bellman operator of the current policy to Vpi.
+             */
+            void apply_policy_operator(std::vector<double>& Vpi, int k);
+
+            /**
+             * @brief y = (I - gamma P_pi) x for the current policy.
+             */
+            void multiply(const std::vector<double>& x, std::vector<double>& y) const;
+
+            /**
+             * @brief Make policy greedy with respect to V.
+             * @details The action of a state is only changed if it improves its value by more than tolerance.
+             * Returns the number of changed actions, and stores the span of T(V) - V in greedy_span.
+             */
+            int improve_policy();
+
+            /**
+             * MDP object.
+             */
+            FiniteMDP& mdp;
+
+            /**
+             * Entries of the row (s, pi(s)) of mdp.transitions for the current policy pi
+             */
+            std::vector<int> row_begin;
+            std::vector<int> row_end;
+
+            /**
+             * Expected reward of each state under the current policy
+             */
+            std::vector<double> r_pi;
+
+            /**
+             * Probability of staying in each state under the current policy
+             */
+            std::vector<double> diagonal;
+
+            /**
+             * Span of T(V) - V in the last greedy step
+             */
+            double greedy_span;
+
+        public:
+            /**
+             * Discount factor
+             */
+            double gamma;
+
+            /**
+             * Precision of the policy evaluation
+             */
+            double tolerance;
+
+            /**
+             * Maximum number of policy improvements
+             */
+            int max_iterations;
+
+            /**
+             * Solver used to evaluate the policies. Default = gauss_seidel_solver.
+             */
+            evaluation_solver solver;
+
+            /**
+             * Relaxation factor of sor_solver, in (0, 2). Default = 1.5.
+             */
+            double omega;
+
+            /**
+             * Maximum number of iterations of the solver for each evaluation
+             */
+            int max_solver_iterations;
+
+            /**
+             * Number of evaluation sweeps in modified policy iteration. Default = 0 (exact evaluation).
+             */
+            int evaluation_sweeps;
+
+            /**
+             * Policy. Size ns.
+             */
+            std::vector<int> policy;
+
+            /**
+             * Value of the policy. Size ns.
+             */
+            std::vector<double> V;
+
+            /**
+             * Number of policy improvements done by the last call to run()
+             */
+            int iterations;
+
+            /**
+             * Total number of solver iterations (or evaluation sweeps) in the last call to run()
+             */
+            int solver_iterations;
+
+            /**
+             * True if the last call to run() stopped before max_iterations.
+             */
+            bool converged;
+    };
+}
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef __SPARSE_TRANSITIONS_H__
+#define __SPARSE_TRANSITIONS_H__
+
+/**
+ * @file
+ * @brief Sparse (CSR) representation of the transitions and mean rewards of a finite MDP.
+ */
+
+#include <vector>
+#include "utils.h"
+
+namespace mdp
+{
+    /**
+     * @brief Transition probabilities and mean rewards of a finite MDP, stored row by row in CSR format.
+     * @details Each state-action pair (s, a) owns a row, i.e. a list of (next_state, prob, reward) triples
+     * containing only the next states that can be reached with positive probability. The triples of all rows
+     * are stored contiguously in next_states(), probs() and rewards(), and the entries of row (s, a) are
+     * k = row_begin(s, a), ..., row_end(s, a) - 1, sorted by next state.
+     *
+     * Rows are built in order (s, a) = (0, 0), (0, 1), ..., (ns-1, na-1) by calling add() for each entry of the
+     * current row, then end_row(). The arrays are read-only: existing entries are modified with set_next_state(),
+     * set_prob() and set_reward(), so that every modification changes stamp().
+     */
+    class SparseTransitions
+    {
+    public:
+        /**
+         * @brief Default constructor. Builds an empty object.
+         */
+        SparseTransitions();
+
+        /**
+         * @brief Initialize object with no rows. Rows must then be built with add() and end_row().
+         * @param _ns number of states
+         * @param _na number of actions
+         * @param nnz_hint expected number of entries, used to reserve memory.
+         */
+        SparseTransitions(int _ns, int _na, int nnz_hint = 0);
+
+        /**
+         * @brief Build sparse representation from dense arrays, dropping entries with zero probability.
+         * @param P dense transitions, P(s, a, s') = probability of reaching s' by taking a in s.
+         * @param R dense mean rewards, same shape as P.
+         */
+        SparseTransitions(const utils::vec::tensor_3d& P, const utils::vec::tensor_3d& R);
+
+        /**
+         * @brief Add an entry to the current row.
+         * @details If next_state is already in the current row, prob is added to its probability and the reward
+         * is replaced by the probability-weighted average of the two rewards.
+         * @param next_state
+         * @param prob
+         * @param reward mean reward of the transition
+         */
+        void add(int next_state, double prob, double reward);
+
+        /**
+         * @brief Close the current row: sort its entries by next state and remove entries with zero probability.
+         */
+        void end_row();
+
+        /**
+         * @brief Returns true if all the ns*na rows have been built.
+         */
+        bool complete() const;
+
+        /**
+         * @brief Index of the first entry of row (s, a)
+         */
+        int row_begin(int s, int a) const { return row_offsets[s*na + a]; }
+
+        /**
+         * @brief One past the index of the last entry of row (s, a)
+         */
+        int row_end(int s, int a) const { return row_offsets[s*na + a + 1]; }
+
+        /**
+         * @brief Total number of stored entries
+         */
+        int nnz() const { return entry_next_states.size(); }
+
+        /**
+         * @brief Row offsets: row (s, a) is made of the entries row_ptr()[s*na + a] to row_ptr()[s*na + a + 1] - 1.
+         * Size ns*na + 1 once complete.
+         */
+        const std::vector<int>& row_ptr() const { return row_offsets; }
+
+        /**
+         * @brief Next state of each entry
+         */
+        const std::vector<int>& next_states() const { return entry_next_states; }
+
+        /**
+         * @brief Transition probability of each entry
+         */
+        const std::vector<double>& probs() const { return entry_probs; }
+
+        /**
+         * @brief Mean reward of each entry
+         */
+        const std::vector<double>& rewards() const { return entry_rewards; }
+
+        /**
+         * @brief Set the next state of entry k. Rows are not sorted again.
+         */
+        void set_next_state(int k, int next_state);
+
+        /**
+         * @brief Set the probability of entry k. The probabilities of each row must still sum to one.
+         */
+        void set_prob(int k, double prob);
+
+        /**
+         * @brief Set the mean reward of entry k.
+         */
+        void set_reward(int k, double reward);
+
+        /**
+         * @brief Probability of reaching next_state by taking action in state (zero if not stored).
+         */
+        double prob(int state, int action, int next_state) const;
+
+        /**
+         * @brief Mean reward of the transition (state, action, next_state) (zero if not stored).
+         */
+        double reward(int state, int action, int next_state) const;
+
+        /**
+         * @brief Dense vector of size ns with the transition probabilities of row (state, action).
+         */
+        std::vector<double> dense_row(int state, int action) const;
+
+        /**
+         * @brief Identifier of the current contents, changed by every call to add(), end_row() and to the setters.
+         * @details Used by objects that cache data derived from the transitions (e.g., the samplers of
+         * mdp::FiniteMDP) to detect modifications. Two objects never share a stamp unless one is a copy of the other.
+         */
+        unsigned long stamp() const { return current_stamp; }
+
+    private:
+        /**
+         * Give a new stamp to the transitions.
+         */
+        void touch();
+
+        /**
+         * Index of the entry of next_state in the current row, or -1.
+         */
+        int find_in_current_row(int next_state) const;
+
+        /**
+         * Identifier of the current contents, see stamp().
+         */
+        unsigned long current_stamp;
+
+        /**
+         * Arrays returned by row_ptr(), next_states(), probs() and rewards()
+         */
+        std::vector<int> row_offsets;
+        std::vector<int> entry_next_states;
+        std::vector<double> entry_probs;
+        std::vector<double> entry_rewards;
+
+    public:
+        /**
+         * Number of states
+         */
+        int ns;
+
+        /**
+         * Number of actions
+         */
+        int na;
+    };
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef __VALUEITERATION_H__
+#define __VALUEITERATION_H__
+
+#include <vector>
+#include "finitemdp.h"
+#include "utils.h"
+
+namespace mdp
+{
+    /**
+     * @brief Order in which value iteration updates the states.
+     * - jacobi: each sweep computes the new values from the values of the previous sweep.
+     * - gauss_seidel: each sweep updates the values in place, so the backup of a state uses the values
+     * already updated in the current sweep. Usually converges in fewer sweeps.
+     */
+    enum sweep_type {jacobi, gauss_seidel};
+
+    /**
+     * @brief Class to run value iteration for the discounted, infinite-horizon criterion in a finite MDP.
+     * @details Each sweep applies the Bellman optimality operator, V(s) <- max_a sum_s' P(s'|s,a)(R(s,a,s') + gamma V(s')),
+     * until the change of V is small enough for the greedy policy to be epsilon-optimal:
+     * - jacobi: the span seminorm of the change, max_s(V_new(s) - V(s)) - min_s(V_new(s) - V(s)), is smaller than
+     * epsilon*(1-gamma)/gamma. V is then shifted to the midpoint of the bounds on V* given by the last change, so that
+     * |V - V*| < epsilon/2. The span usually decreases much faster than the sup norm.
+     * - gauss_seidel: the sup norm of the change is smaller than epsilon*(1-gamma)/(2*gamma). The span cannot be used
+     * here, since the in-place updates do not give bounds on V*.
+     *
+     * The working memory is O(ns): one value vector for gauss_seidel sweeps, two for jacobi sweeps. The Q function
+     * (ns x na) is only stored if store_q is true.
+     */
+    class ValueIteration
+    {
+        public:
+            /**
+             * @param mdp FiniteMDP object
+             * @param gamma discount factor, in [0, 1)
+             * @param epsilon precision
+             * @param max_iterations maximum number of sweeps
+             */
+            ValueIteration(FiniteMDP& mdp, double gamma, double epsilon = 1e-6, int max_iterations = 100000);
+
+            /**
+             * @brief Run value iteration, starting from V (or from zero if V is empty or has the wrong size).
+             * @details Store results in V, greedy_policy, and Q if store_q is true.
+             */
+            void run();
+
+            /**
+             * @brief Compute the greedy policy with respect to V and, if store_q is true, the corresponding Q.
+             */
+            void compute_greedy_policy();
+
+        protected:
+            /**
+             * @brief One sweep over all states. Stores the smallest and largest change of V in diff_min and diff_max.
+             */
+            void sweep();
+
+            /**
+             * MDP object.
+             */
+            FiniteMDP& mdp;
+
+            /**
+             * Values of the previous sweep (jacobi sweeps only).
+             */
+            std::vector<double> V_old;
+
+            /**
+             * Action values of the current state.
+             */
+            std::vector<double> q;
+
+            /**
+             * Smallest and largest change of V in the last sweep.
+             */
+            double diff_min;
+            double diff_max;
+
+        public:
+            /**
+             * Discount factor
+             */
+            double gamma;
+
+            /**
+             * Precision of the value function: the greedy policy is epsilon-optimal after convergence.
+             */
+            double epsilon;
+
+            /**
+             * Maximum number of sweeps
+             */
+            int max_iterations;
+
+            /**
+             * Order of the updates. Default = gauss_seidel.
+             */
+            sweep_type sweep_order;
+
+            /**
+             * If true, store the Q function at the end of run(). Default = false.
+             */
+            bool store_q;
+
+            /**
+             * Value function. Size ns.
+             */
+            std::vector<double> V;
+
+            /**
+             * Greedy policy with respect to V. Size ns.
+             */
+            std::vector<int> greedy_policy;
+
+            /**
+             * Q function (ns x na), empty unless store_q is true.
+             */
+            utils::vec::vec_2d Q;
+
+            /**
+             * Number of sweeps done by the last call to run()
+             */
+            int iterations;
+
+            /**
+             * Change of V in the last sweep: span seminorm for jacobi sweeps, sup norm for gauss_seidel sweeps.
+             */
+            double residual;
+
+            /**
+             * True if the last call to run() reached the required precision before max_iterations.
+             */
+            bool converged;
+    };
+}
+
+#endif
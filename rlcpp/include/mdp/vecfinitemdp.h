@@ -0,0 +1,178 @@
+#ifndef __VECFINITEMDP_H__
+#define __VECFINITEMDP_H__
+
+/**
+ * @file
+ * @brief Vectorized environment running many independent episodes of a finite MDP.
+ */
+
+#include <vector>
+#include <memory>
+#include "finitemdp.h"
+#include "random.h"
+
+namespace mdp
+{
+    /**
+     * @brief Results of a step of a vectorized environment, stored as one array per variable.
+     * @details Entry i of each array corresponds to the environment (slot) i.
+     */
+    struct StepBatch
+    {
+        /**
+         * @brief Resize the arrays to n entries.
+         */
+        void resize(int n)
+        {
+            next_states.resize(n);
+            rewards.resize(n);
+            dones.resize(n);
+        }
+
+        /**
+         * @brief Number of entries
+         */
+        int size() const { return next_states.size(); }
+
+        /**
+         * State reached by each slot. For a finished slot, this is the last state of the episode, and not the
+         * state to which the slot was reset.
+         */
+        std::vector<int> next_states;
+
+        /**
+         * Reward obtained by each slot
+         */
+        std::vector<double> rewards;
+
+        /**
+         * 1 if the episode of the slot is finished (terminal state reached or horizon elapsed), 0 otherwise.
+         */
+        std::vector<unsigned char> dones;
+    };
+
+    /**
+     * @brief N independent copies (slots) of a finite MDP, stepped together.
+     * @details The transitions, rewards and sampling tables of the MDP are built once and shared, read-only, by
+     * all the slots (and by the copies of the object), so that each slot only stores its state, the number of
+     * steps of its episode and its random number generator. Slot i samples with the stream i of a
+     * utils::rand::Philox4x32 generator: its trajectory only depends on the seed, on i and on its actions.
+     *
+     * A slot whose episode finishes in step() is reset to the default state of the MDP, so that the next action
+     * of the slot is taken from the default state.
+     */
+    class VecFiniteMDP
+    {
+    public:
+        /**
+         * @param mdp MDP to copy. Later modifications of mdp do not affect this object.
+         * @param n_envs number of slots
+         * @param seed seed of the random number generators
+         * @param horizon if horizon > 0, episodes also finish after horizon steps
+         */
+        VecFiniteMDP(const FiniteMDP& mdp, int n_envs, unsigned seed = 42, int horizon = 0);
+
+        /**
+         * @brief Put all the slots in the default state.
+         */
+        void reset();
+
+        /**
+         * @brief Put slot i in the default state.
+         */
+        void reset(int i);
+
+        /**
+         * @brief Take one step in each slot.
+         * @param actions action of each slot, array of size size()
+         * @param out results. Resized to size() if needed.
+         */
+        void step(const int* actions, StepBatch& out);
+
+        /**
+         * @brief Number of slots
+         */
+        int size() const { return states.size(); }
+
+        /**
+         * @brief Set the seed of the generators, and restart the stream of each slot.
+         */
+        void set_seed(unsigned seed);
+
+    private:
+        /**
+         * @brief Read-only data of the MDP shared by the slots.
+         */
+        struct Model
+        {
+            /**
+             * Transitions, in the format of SparseTransitions: entries row_ptr[s*na + a] to
+             * row_ptr[s*na + a + 1] - 1 correspond to (s, a).
+             */
+            std::vector<int> row_ptr;
+            std::vector<int> next_states;
+            std::vector<double> rewards;
+
+            /**
+             * Alias tables of the rows, see utils::rand::build_alias_table().
+             */
+            std::vector<double> alias_prob;
+            std::vector<int> alias_index;
+
+            /**
+             * 1 for terminal states and 0 otherwise
+             */
+            std::vector<unsigned char> terminal_mask;
+
+            /**
+             * Standard deviation of the gaussian reward noise, or 0.
+             */
+            double noise_sigma;
+        };
+
+        std::shared_ptr<const Model> model;
+
+        /**
+         * Random number generator of each slot
+         */
+        std::vector<utils::rand::Philox4x32> generators;
+
+    public:
+        /**
+         * Current state of each slot
+         */
+        std::vector<int> states;
+
+        /**
+         * Number of steps in the current episode of each slot
+         */
+        std::vector<int> episode_steps;
+
+        /**
+         * Number of states
+         */
+        int ns;
+
+        /**
+         * Number of actions
+         */
+        int na;
+
+        /**
+         * State in which the slots are reset
+         */
+        int default_state;
+
+        /**
+         * Maximum length of the episodes, or 0 if they only finish in terminal states.
+         */
+        int horizon;
+
+        /**
+         * MDP identifier
+         */
+        std::string id;
+    };
+}
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef __VECMOUNTAINCAR_H__
+#define __VECMOUNTAINCAR_H__
+
+/**
+ * @file
+ * @brief Vectorized environment running many independent episodes of MountainCar.
+ */
+
+#include <vector>
+#include <string>
+#include "random.h"
+#include "tensor.h"
+
+namespace mdp
+{
+    /**
+     * @brief Array of doubles aligned to 64 bytes.
+     */
+    typedef std::vector<double, utils::vec::AlignedAllocator<double>> aligned_vector;
+
+    /**
+     * @brief Results of a step of VecMountainCar, stored as one array per variable.
+     * @details Entry i of each array corresponds to the car (slot) i.
+     */
+    struct MountainCarStepBatch
+    {
+        /**
+         * @brief Resize the arrays to n entries.
+         */
+        void resize(int n)
+        {
+            positions.resize(n);
+            velocities.resize(n);
+            rewards.resize(n);
+            dones.resize(n);
+        }
+
+        /**
+         * @brief Number of entries
+         */
+        int size() const { return positions.size(); }
+
+        /**
+         * State (position and velocity) reached by each car. For a finished slot, this is the last state of the
+         * episode, and not the state to which the slot was reset.
+         */
+        aligned_vector positions;
+        aligned_vector velocities;
+
+        /**
+         * Reward obtained by each car: 1 if it reached the goal, 0 otherwise.
+         */
+        aligned_vector rewards;
+
+        /**
+         * 1 if the episode of the slot is finished (goal reached or horizon elapsed), 0 otherwise.
+         */
+        std::vector<unsigned char> dones;
+    };
+
+    /**
+     * @brief N independent mountain cars, stepped together. See mdp::MountainCar for the dynamics.
+     * @details The positions and the velocities of the cars are stored in two aligned arrays, and all the cars
+     * are moved by the same kernel: on x86 processors supporting AVX2, four cars are moved at once, with a
+     * polynomial approximation of the cosine. The scalar kernel uses the same operations, so both kernels
+     * give the same results.
+     *
+     * A slot whose episode finishes in step() is reset to a random position with zero velocity. Slot i samples
+     * its initial positions with the stream i of a utils::rand::Philox4x32 generator.
+     */
+    class VecMountainCar
+    {
+    public:
+        /**
+         * @param n_envs number of cars
+         * @param seed seed of the random number generators
+         * @param horizon if horizon > 0, episodes also finish after horizon steps
+         */
+        VecMountainCar(int n_envs, unsigned seed = 42, int horizon = 0);
+
+        /**
+         * @brief Put all the cars in a random initial state.
+         */
+        void reset();
+
+        /**
+         * @brief Put car i in a random initial state: uniform position, zero velocity.
+         */
+        void reset(int i);
+
+        /**
+         * @brief Take one step with each car.
+         * @param actions action of each car (0, 1 or 2), array of size size()
+         * @param out results. Resized to size() if needed.
+         */
+        void step(const int* actions, MountainCarStepBatch& out);
+
+        /**
+         * @brief Number of cars
+         */
+        int size() const { return positions.size(); }
+
+        /**
+         * @brief Set the seed of the generators, and restart the stream of each slot.
+         */
+        void set_seed(unsigned seed);
+
+        /**
+         * @brief Cosine used by the kernels, valid for |x| <= 3*pi/2.
+         * @details Reduction to [-pi/2, pi/2] and Taylor polynomial of degree 20; the absolute error is
+         * below 1e-15.
+         */
+        static double cosine(double x);
+
+        /**
+         * @brief Name of the instruction set used by step(): "avx2" or "scalar".
+         */
+        std::string instruction_set() const;
+
+    private:
+        /**
+         * Random number generator of each slot
+         */
+        std::vector<utils::rand::Philox4x32> generators;
+
+    public:
+        /**
+         * Position of each car, in [min_position, max_position]
+         */
+        aligned_vector positions;
+
+        /**
+         * Velocity of each car, in [-max_speed, max_speed]
+         */
+        aligned_vector velocities;
+
+        /**
+         * Number of steps in the current episode of each slot
+         */
+        std::vector<int> episode_steps;
+
+        /**
+         * Maximum length of the episodes, or 0 if they only finish at the goal.
+         */
+        int horizon;
+
+        /**
+         * If false, step() uses the scalar kernel even if AVX2 is supported. Default = true.
+         */
+        bool use_simd;
+
+        /**
+         * Number of actions
+         */
+        int na;
+
+        /**
+         * MDP identifier
+         */
+        std::string id;
+
+        /**
+         * Bounds of the state, goal, force and gravity, as in mdp::MountainCar.
+         */
+        static constexpr double min_position = -1.2;
+        static constexpr double max_position = 0.6;
+        static constexpr double max_speed = 0.07;
+        static constexpr double goal_position = 0.5;
+        static constexpr double goal_velocity = 0;
+        static constexpr double force = 0.001;
+        static constexpr double gravity = 0.0025;
+    };
+}
+
+#endif
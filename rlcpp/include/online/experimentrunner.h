@@ -0,0 +1,119 @@
+#ifndef __EXPERIMENTRUNNER_H__
+#define __EXPERIMENTRUNNER_H__
+
+#include <memory>
+#include <functional>
+#include <string>
+#include <vector>
+#include "finitemdp.h"
+#include "abstractalgorithm.h"
+#include "utils.h"
+
+namespace online
+{
+    /**
+     * @brief Environment and algorithm of one run of an experiment.
+     */
+    struct Trial
+    {
+        /**
+         * Environment.
+         */
+        std::shared_ptr<mdp::FiniteMDP> mdp;
+        /**
+         * Algorithm interacting with mdp.
+         */
+        std::shared_ptr<Algorithm> algorithm;
+        /**
+         * Optional function running one episode of algorithm and returning its initial state (e.g., to pass the
+         * true value function to UCBVI::run_episode()). If it is not set, algorithm->run_episode() is called.
+         */
+        std::function<int()> run_episode;
+        /**
+         * Regret of the last episode run by algorithm, given its initial state (returned by run_episode()).
+         */
+        std::function<double(int)> episode_regret;
+        /**
+         * Optional function called after the last episode, before the trial is destroyed (e.g., to save the
+         * history of mdp).
+         */
+        std::function<void()> finish;
+    };
+
+    /**
+     * @brief Function creating the trial of a configuration, given its index (from 0 to n_configs-1) and a seed.
+     * @details It is called concurrently from several threads, and must not modify shared data.
+     */
+    typedef std::function<Trial(int config, unsigned seed)> TrialFactory;
+
+    /**
+     * @brief Run several configurations of an experiment with several seeds, in parallel.
+     * @details Each (configuration, seed) pair is a task of a utils::parallel::TaskPool: the trial is created by
+     * the factory, runs n_episodes episodes, and is destroyed. Its cumulative regret after each episode is stored
+     * in regret, then averaged over the seeds.
+     */
+    class ExperimentRunner
+    {
+    public:
+        /**
+         * @param factory function creating the trials
+         * @param n_configs number of configurations
+         * @param n_seeds number of seeds for each configuration. The seeds are first_seed, ..., first_seed+n_seeds-1.
+         * @param n_episodes number of episodes of each trial
+         * @param n_threads number of threads. If n_threads < 1, use std::thread::hardware_concurrency().
+         */
+        ExperimentRunner(TrialFactory factory, int n_configs, int n_seeds, int n_episodes, int n_threads = 0);
+
+        /**
+         * @brief Run all the trials, and store the results in regret, mean_regret and std_regret.
+         * @details If a trial throws an exception (in the factory or in the algorithm), the first one is rethrown
+         * once all the trials are finished.
+         */
+        void run();
+
+        /**
+         * @brief Write the cumulative regret of a configuration in a csv file, with one column per seed.
+         * @details Row k is the regret after k episodes: the first row contains zeros, and the file has
+         * n_episodes + 1 rows.
+         * @param config index of the configuration
+         * @param filename example: "myfile.csv"
+         */
+        void to_csv(int config, std::string filename) const;
+
+        /**
+         * Function creating the trials.
+         */
+        TrialFactory factory;
+
+        /**
+         * Number of configurations, of seeds per configuration and of episodes per trial.
+         */
+        int n_configs;
+        int n_seeds;
+        int n_episodes;
+
+        /**
+         * Number of threads running the trials.
+         */
+        int n_threads;
+
+        /**
+         * Seed of the first trial of each configuration. Default = 1.
+         */
+        unsigned first_seed;
+
+        /**
+         * Cumulative regret after each episode: regret[config][i][k] is the regret of the seed first_seed+i
+         * after k+1 episodes. Shape (n_configs, n_seeds, n_episodes).
+         */
+        std::vector<utils::vec::vec_2d> regret;
+
+        /**
+         * Mean and standard deviation over the seeds of the cumulative regret. Shape (n_configs, n_episodes).
+         */
+        utils::vec::vec_2d mean_regret;
+        utils::vec::vec_2d std_regret;
+    };
+}
+
+#endif
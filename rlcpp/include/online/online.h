@@ -3,6 +3,7 @@
 
 #include "abstractalgorithm.h"
 #include "ucbvi.h"
+#include "experimentrunner.h"
 
 /**
  * @file 
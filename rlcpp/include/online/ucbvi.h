@@ -1,6 +1,7 @@
 #ifndef __UCBVI_H__
 #define __UCBVI_H__
 
+#include <cmath>
 #include "abstractmdp.h"
 #include "finitemdp.h"
 #include "episodicvi.h"
@@ -20,10 +21,11 @@ class UCBVI: public Algorithm
          * @param scale_factor factor by which to multiply the exploration bonus
          * @param b_type type of bonus. must be "hoeffding" or "bernstein"
          * @param save_history if true, save transtitions and regret in mdp.history
+         * @param seed seed of the noise used to break ties between actions
          */
         UCBVI(mdp::FiniteMDP& mdp, int horizon,
             double scale_factor=1, std::string b_type="bernstein",
-            bool save_history=true);
+            bool save_history=true, unsigned seed=42);
 
         /**
          * @brief Reset all variables.
@@ -34,23 +36,36 @@ class UCBVI: public Algorithm
         /**
          * @brief Compute optimistic Q function.
          * @details Run optimistic value iteration, store data in Q and V.
+         * If incremental_planning is true, only the backups whose inputs changed since the previous call are
+         * recomputed (see incremental_planning).
          */
         void get_optimistic_q();
 
         /**
-         * @brief Compute Hoeffding exploration bonus.
+         * @brief Hoeffding exploration bonus of (s, a).
          * @details
          *      bonus(x, a) = scale_factor* 7 * H * L * sqrt*(1 / (visits to (x,a)))
          *      where L = log(5*S*A*max(1, visits to (x,a))/delta)
          */
-        void compute_hoeffding_bonus();
+        double hoeffding_bonus(int s, int a) const
+        {
+            return scale_factor * hoeffding_factor[s][a];
+        }
 
         /**
-         * @brief Compute Bernstein exploration bonus.
+         * @brief Bernstein exploration bonus of (s, a).
          * @details See Algorithm 4 in [1]
+         *      bonus(x, a) = scale_factor * (sqrt(8 * L * variance / n) + 14 * L * H / (3*n) + sqrt(8 * H * H / n))
+         *      where n = max(1, visits to (x,a)) and L = log(5*S*A*n/delta)
          * [1] Azar et al., 2017. Minimax Regret Bounds for Reinforcement Learning
+         * @param s state
+         * @param a action
+         * @param variance variance of the next stage value under the estimated transitions of (s, a)
          */
-        void compute_bernstein_bonus(int h,  std::vector<double> Vhp1);
+        double bernstein_bonus(int s, int a, double variance) const
+        {
+            return scale_factor * (sqrt(bernstein_variance_factor[s][a] * variance) + bernstein_offset[s][a]);
+        }
 
         /**
          * @brief Run one episode
@@ -75,7 +90,74 @@ class UCBVI: public Algorithm
          */
         void update(int state, int action, double reward, int next_state);
 
+        /**
+         * @brief Number of visits to (state, action, next_state).
+         */
+        int n_sas(int state, int action, int next_state) const;
+
+        /**
+         * @brief Estimate of the probability of reaching next_state by taking action in state.
+         */
+        double phat(int state, int action, int next_state) const
+        {
+            return n_sas(state, action, next_state) * inv_N_sa[state][action];
+        }
+
+        /**
+         * @brief Estimate of the mean reward obtained by taking action in state.
+         */
+        double rhat(int state, int action) const
+        {
+            return R_sum[state][action] * inv_N_sa[state][action];
+        }
+
     protected:
+        /**
+         * @brief Recompute all the backups (h, s, a).
+         */
+        void full_planning();
+
+        /**
+         * @brief Recompute only the backups affected by the updates since the previous planning.
+         */
+        void incremental_planning_sweep();
+
+        /**
+         * @brief Compute the bonus factors of (s, a) from its number of visits.
+         */
+        void update_bonus_factors(int s, int a);
+
+        /**
+         * @brief Mean and variance of v[next state] under the estimated transitions of (s, a), computed in a
+         * single pass over the observed next states. Returns the mean, and stores the variance in variance.
+         */
+        double next_value_moments(int s, int a, const double* v, double* variance) const;
+
+        /**
+         * @brief Expected reward plus value of the next state under the estimated model:
+         * (R_sum[s][a] + sum_sn n_sas(s, a, sn) v[sn]) / N_sa[s][a], or 0 if (s, a) was not visited.
+         */
+        double empirical_backup(int s, int a, const double* v) const;
+
+        /**
+         * @brief Compute Q(h, s, a), including its bonus, given the values at stage h+1.
+         * @details With Bernstein bonuses, the variance used by the bonus and the expected value used by Q are
+         * computed in the same pass.
+         */
+        void backup(int h, int s, int a);
+
+        /**
+         * @brief Noise in [0, 1e-10) added to Q(h, s, a) to break ties between actions.
+         * @details Hash of (seed, h, s, a): it does not depend on the order of the backups nor on a global
+         * generator, so that the planning is reproducible for a given seed and can run in several threads.
+         */
+        double tie_break_noise(int h, int s, int a) const;
+
+        /**
+         * @brief Compute V[h][s] and policy[h][s] from Q(h, s, .).
+         */
+        void update_value(int h, int s);
+
         /**
          * MDP used by the algorithm.
          */
@@ -101,19 +183,52 @@ class UCBVI: public Algorithm
          */
         double delta;
 
-    public:
         /**
-         * Estimate of transition probabilities. Shape (S, A, S).
+         * State-action pairs (s*na + a) updated since the last planning, and a flag for each pair.
+         */
+        std::vector<int> updated_pairs;
+        std::vector<char> pair_updated;
+
+        /**
+         * For each next state sn, the state-action pairs (s*na + a) from which sn has been observed.
+         */
+        std::vector<std::vector<int>> predecessors;
+
+        /**
+         * Visit counts at the last replanning, and true if some count doubled since then (used if rarely_switching).
+         */
+        utils::vec::ivec_2d N_sa_at_plan;
+        bool replan_needed;
+
+        /**
+         * Parts of the bonuses of each state-action pair that only depend on its number of visits, updated when
+         * the number of visits changes. Shape (S, A).
+         * - Hoeffding bonus: scale_factor * hoeffding_factor
+         * - Bernstein bonus: scale_factor * (sqrt(bernstein_variance_factor * variance) + bernstein_offset)
+         */
+        utils::vec::vec_2d hoeffding_factor;
+        utils::vec::vec_2d bernstein_variance_factor;
+        utils::vec::vec_2d bernstein_offset;
+
+        /**
+         * Bonus type used by the current planning, to avoid comparing b_type in each backup.
          */
-        utils::vec::vec_3d Phat;
+        bool use_hoeffding;
+        bool use_bernstein;
+
         /**
-         * Estimate of rewards. Shape (S, A, S).
+         * False until a full planning has been done, then true as long as the bonus parameters
+         * (b_type and scale_factor) are those of planned_b_type and planned_scale_factor.
          */
-        utils::vec::vec_3d Rhat;
+        bool planned;
+        std::string planned_b_type;
+        double planned_scale_factor;
+
+    public:
         /**
          * Optimistic Q function. Shape (H+1, S, A).
          */
-        utils::vec::vec_3d Q;
+        utils::vec::tensor_3d Q;
         /**
          * Optimistic V function. Shape (H+1, S).
          */
@@ -123,18 +238,30 @@ class UCBVI: public Algorithm
          * Shape (H+1, S)
          */
         utils::vec::vec_2d Vpi;
-        /**
-         * Exploration bonus. Shape (H, S, A).
-         */
-        utils::vec::vec_3d bonus;
         /**
          * Number of visits to each state-action pair. Shape (S, A).
          */
         utils::vec::ivec_2d N_sa;
         /**
-         * Number of visits to each state-action-next state tuple. Shape (S, A, S).
+         * Next states observed from each state-action pair, in order of first observation.
+         * Indexed by s*A + a. The memory used by the model is proportional to the number of distinct
+         * observed transitions, instead of S*A*S.
+         */
+        std::vector<std::vector<int>> successors;
+        /**
+         * Number of visits to each observed transition: successor_counts[s*A + a][k] is the number of visits to
+         * (s, a, successors[s*A + a][k]). The transition estimates are these counts divided by N_sa[s][a],
+         * see phat().
+         */
+        std::vector<std::vector<int>> successor_counts;
+        /**
+         * 1/N_sa, or 0 for pairs that were never visited. Shape (S, A).
+         */
+        utils::vec::vec_2d inv_N_sa;
+        /**
+         * Sum of the rewards obtained in each state-action pair. Shape (S, A).
          */
-        utils::vec::ivec_3d N_sas;
+        utils::vec::vec_2d R_sum;
         /**
          * Greedy (optimistic) policy, updated after each episode. Shape (H, S).
          */ 
@@ -160,6 +287,37 @@ class UCBVI: public Algorithm
          */
         std::string b_type;
 
+        /**
+         * If true, get_optimistic_q() only recomputes the backups (h, s, a) whose inputs changed since its
+         * previous call: the pairs (s, a) updated during the last episode, at all stages, and the pairs leading to
+         * a state whose value changed at the next stage. A full sweep is done at the first planning and when the
+         * bonus parameters (b_type or scale_factor) change. Default = false.
+         */
+        bool incremental_planning;
+
+        /**
+         * Number of backups (h, s, a) computed by the last call to get_optimistic_q().
+         */
+        long planning_backups;
+
+        /**
+         * If true, run_episode() only replans (computes the optimistic Q and evaluates the new policy) when the
+         * number of visits to some state-action pair has doubled since the last replanning. Otherwise, the policy,
+         * Q, V and Vpi of the last replanning are reused. The number of replannings is then O(SA log K) in K
+         * episodes. Default = false.
+         */
+        bool rarely_switching;
+
+        /**
+         * Number of replannings since the last reset().
+         */
+        int n_replans;
+
+        /**
+         * Seed of the tie-breaking noise added to Q, see tie_break_noise().
+         */
+        unsigned seed;
+
         /**
          * If true, the following variables are saved in mdp.history after each step:
          * (episode, state, action, next_state, reward, regret)
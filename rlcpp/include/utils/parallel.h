@@ -0,0 +1,333 @@
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+/**
+ * @file
+ * @brief Thread pools for parallel loops and independent tasks, and a lock-free queue.
+ */
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace utils
+{
+    /**
+     * Utils for multithreading.
+     */
+    namespace parallel
+    {
+        /**
+         * @brief How the iterations of a parallel loop are distributed among threads.
+         * - static_schedule: each thread processes one contiguous block of (end-begin)/n_threads iterations.
+         * - dynamic_schedule: threads repeatedly take the next chunk of chunk_size iterations.
+         */
+        enum schedule_type {static_schedule, dynamic_schedule};
+
+        /**
+         * @brief Fixed set of threads executing parallel loops.
+         * @details The threads are created once, in the constructor, and wait between loops. The thread calling
+         * parallel_for() takes part in the loop, so a pool of size n runs n-1 background threads.
+         */
+        class ThreadPool
+        {
+        public:
+            /**
+             * @param n_threads number of threads used in each loop, including the calling thread.
+             * If n_threads < 1, use std::thread::hardware_concurrency().
+             */
+            ThreadPool(int n_threads);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            /**
+             * @brief Run body(lo, hi) on sub-ranges [lo, hi) covering [begin, end), and wait for completion.
+             * @param begin first iteration
+             * @param end one past the last iteration
+             * @param body function called on each sub-range. Calls on different sub-ranges may run concurrently.
+             * @param schedule static_schedule or dynamic_schedule
+             * @param chunk_size number of iterations per chunk for dynamic_schedule. If chunk_size < 1, a default
+             * of (end-begin)/(8*size()) iterations is used.
+             */
+            void parallel_for(int begin, int end, const std::function<void(int, int)>& body,
+                              schedule_type schedule = static_schedule, int chunk_size = 0);
+
+            /**
+             * @brief Number of threads used in each loop, including the calling thread.
+             */
+            int size() const { return n_threads; }
+
+        private:
+            /**
+             * @brief Loop run by background thread number id (from 1 to n_threads-1).
+             */
+            void worker_loop(int id);
+
+            /**
+             * @brief Process the part of the current loop assigned to thread id.
+             */
+            void run_share(int id);
+
+            int n_threads;
+            std::vector<std::thread> workers;
+
+            /**
+             * Serializes calls to parallel_for().
+             */
+            std::mutex call_mutex;
+            std::mutex mutex;
+            std::condition_variable start_cv;
+            std::condition_variable done_cv;
+
+            /**
+             * Incremented at each loop, to wake up the background threads.
+             */
+            unsigned long generation = 0;
+            int n_running = 0;
+            bool stopping = false;
+
+            // Current loop
+            const std::function<void(int, int)>* body = nullptr;
+            int begin = 0;
+            int end = 0;
+            schedule_type schedule = static_schedule;
+            int chunk_size = 1;
+            std::atomic<int> next;
+        };
+
+        /**
+         * @brief Fixed set of threads executing independent tasks, with work stealing.
+         * @details Each thread has its own queue of tasks. A thread runs the most recent task of its queue and,
+         * when the queue is empty, steals the oldest task of another queue. Tasks submitted by a task are
+         * pushed to the queue of the thread running it; other tasks are distributed among the queues in turn.
+         * Unlike ThreadPool, the thread submitting the tasks does not run them.
+         */
+        class TaskPool
+        {
+        public:
+            /**
+             * @param n_threads number of threads. If n_threads < 1, use std::thread::hardware_concurrency().
+             */
+            TaskPool(int n_threads = 0);
+
+            /**
+             * @brief Wait for all the submitted tasks, then stop the threads. Exceptions of the tasks that were not
+             * rethrown by wait() are dropped.
+             */
+            ~TaskPool();
+
+            TaskPool(const TaskPool&) = delete;
+            TaskPool& operator=(const TaskPool&) = delete;
+
+            /**
+             * @brief Queue a task. Can be called from any thread, including from a task.
+             */
+            void submit(std::function<void()> task);
+
+            /**
+             * @brief Block until all the submitted tasks are finished.
+             * @details Must not be called from a task. If tasks threw exceptions, the first one is rethrown (once)
+             * after all the tasks are finished; the other ones are dropped.
+             */
+            void wait();
+
+            /**
+             * @brief Number of threads.
+             */
+            int size() const { return n_threads; }
+
+        private:
+            /**
+             * Tasks of one thread. The owner takes tasks from the back, the other threads from the front.
+             */
+            struct TaskQueue
+            {
+                std::mutex mutex;
+                std::deque<std::function<void()>> tasks;
+            };
+
+            /**
+             * @brief Loop run by thread number id.
+             */
+            void worker_loop(int id);
+
+            /**
+             * @brief Take a task from the queue of thread id, or steal one from another queue.
+             * @return false if all the queues are empty
+             */
+            bool pop_task(int id, std::function<void()>& task);
+
+            int n_threads;
+            std::vector<std::thread> workers;
+            std::vector<std::unique_ptr<TaskQueue>> queues;
+
+            std::mutex mutex;
+            std::condition_variable work_cv;
+            std::condition_variable done_cv;
+
+            /**
+             * Number of tasks in the queues, and number of submitted tasks that are not finished.
+             */
+            long n_queued = 0;
+            long n_unfinished = 0;
+            bool stopping = false;
+
+            /**
+             * First exception thrown by a task since the last call to wait(), or null.
+             */
+            std::exception_ptr error;
+
+            /**
+             * Queue receiving the next task submitted from outside the pool.
+             */
+            unsigned next_queue = 0;
+        };
+
+        /**
+         * @brief Bounded queue that can be used by several producer and consumer threads without locks.
+         * @details Ring of cells with sequence numbers (bounded MPMC queue of D. Vyukov): a thread reserves a
+         * cell with a compare-and-swap on the head or on the tail of the queue, and the sequence number of the
+         * cell tells whether it is free or filled. push() and pop() never block: they fail if the queue is
+         * full or empty.
+         * @tparam T type of the elements, default-constructible and movable
+         */
+        template <class T>
+        class LockFreeQueue
+        {
+        public:
+            /**
+             * @param capacity maximum number of elements, rounded up to a power of 2
+             */
+            explicit LockFreeQueue(int capacity);
+
+            LockFreeQueue(const LockFreeQueue&) = delete;
+            LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+            /**
+             * @brief Append value to the queue.
+             * @return false if the queue is full (value is then unchanged)
+             */
+            bool push(T&& value);
+
+            /**
+             * @brief Remove the oldest element of the queue and move it to value.
+             * @return false if the queue is empty
+             */
+            bool pop(T& value);
+
+            /**
+             * @brief Check if there is no element to pop.
+             * @details Exact when called by the only consumer; otherwise the result may be outdated.
+             */
+            bool empty() const;
+
+            /**
+             * @brief Maximum number of elements
+             */
+            int capacity() const { return mask + 1; }
+
+        private:
+            struct Cell
+            {
+                std::atomic<std::size_t> sequence;
+                T value;
+            };
+
+            std::unique_ptr<Cell[]> cells;
+            std::size_t mask;
+
+            // head and tail are on different cache lines, so that producers and consumers do not slow down
+            // each other
+            char padding_0[64];
+            std::atomic<std::size_t> tail;
+            char padding_1[64];
+            std::atomic<std::size_t> head;
+            char padding_2[64];
+        };
+
+        template <class T>
+        LockFreeQueue<T>::LockFreeQueue(int capacity): tail(0), head(0)
+        {
+            std::size_t size = 1;
+            while (size < (std::size_t) std::max(capacity, 1)) size *= 2;
+            cells.reset(new Cell[size]);
+            mask = size - 1;
+            for(std::size_t i = 0; i < size; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        template <class T>
+        bool LockFreeQueue<T>::push(T&& value)
+        {
+            std::size_t position = tail.load(std::memory_order_relaxed);
+            Cell* cell;
+            while (true)
+            {
+                cell = &cells[position & mask];
+                std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                std::intptr_t difference = (std::intptr_t) sequence - (std::intptr_t) position;
+                if (difference == 0)
+                {
+                    // the cell is free: reserve it
+                    if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+                }
+                else if (difference < 0) return false;
+                else position = tail.load(std::memory_order_relaxed);
+            }
+            cell->value = std::move(value);
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        template <class T>
+        bool LockFreeQueue<T>::pop(T& value)
+        {
+            std::size_t position = head.load(std::memory_order_relaxed);
+            Cell* cell;
+            while (true)
+            {
+                cell = &cells[position & mask];
+                std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                std::intptr_t difference = (std::intptr_t) sequence - (std::intptr_t) (position + 1);
+                if (difference == 0)
+                {
+                    // the cell is filled: reserve it
+                    if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+                }
+                else if (difference < 0) return false;
+                else position = head.load(std::memory_order_relaxed);
+            }
+            value = std::move(cell->value);
+            // the cell is free for the push at position + capacity
+            cell->sequence.store(position + mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        template <class T>
+        bool LockFreeQueue<T>::empty() const
+        {
+            std::size_t position = head.load(std::memory_order_relaxed);
+            return cells[position & mask].sequence.load(std::memory_order_acquire) != position + 1;
+        }
+
+        /**
+         * @brief Restrict the calling thread to one of the processors on which the process may run.
+         * @details The processors are those of the affinity mask of the process (e.g., restricted by a cpuset or
+         * a container), in increasing order: the thread is pinned to the processor number index % (their number).
+         * @return true on success. Always false on systems other than Linux, where it has no effect.
+         */
+        bool pin_current_thread(int index);
+    }
+}
+
+#endif
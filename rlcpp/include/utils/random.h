@@ -1,6 +1,7 @@
 #ifndef __RANDOM_H__
 #define __RANDOM_H__
 
+#include <cstdint>
 #include <random>
 #include <vector>
 
@@ -16,17 +17,134 @@ namespace utils
      */
     namespace rand
     {
+        /**
+         * @brief Counter-based random number generator Philox4x32-10 (Salmon et al., 2011. Parallel Random
+         * Numbers: As Easy as 1, 2, 3).
+         * @details Each block of 4 outputs is a bijective function of a 128-bit counter, parametrized by a 64-bit
+         * key. The key is made of a seed and a stream number, and the counter of a substream number (64 bits) and
+         * of the index of the block in the substream (64 bits): every (seed, stream, substream) gives a different
+         * sequence of 2^66 numbers, that can be started or advanced in O(1). The state is made of the key, the
+         * counter and the current block.
+         * Satisfies the UniformRandomBitGenerator requirements, and can be used with the distributions of <random>.
+         */
+        class Philox4x32
+        {
+        public:
+            typedef std::uint32_t result_type;
+
+            /**
+             * @param seed seed, first half of the key
+             * @param stream stream number, second half of the key
+             * @param substream substream number, higher half of the counter
+             */
+            Philox4x32(std::uint32_t seed = 0, std::uint32_t stream = 0, std::uint64_t substream = 0)
+            {
+                set_stream(seed, stream, substream);
+            }
+
+            /**
+             * @brief Go to the beginning of the sequence (seed, stream, substream).
+             */
+            void set_stream(std::uint32_t seed, std::uint32_t stream, std::uint64_t substream = 0);
+
+            /**
+             * @brief Go to the beginning of the sequence (seed, 0, 0).
+             */
+            void seed(std::uint32_t _seed) { set_stream(_seed, 0, 0); }
+
+            /**
+             * @brief Skip the next n outputs, in O(1).
+             */
+            void discard(unsigned long long n);
+
+            /**
+             * @brief Next output.
+             */
+            result_type operator()()
+            {
+                if (index == 4)
+                {
+                    increment_counter();
+                    index = 0;
+                }
+                return buffer[index++];
+            }
+
+            static constexpr result_type min() { return 0; }
+            static constexpr result_type max() { return 0xffffffffu; }
+
+            /**
+             * @brief Compute the block of 4 outputs of a counter with a key (10 rounds).
+             */
+            static void block(const std::uint32_t counter[4], const std::uint32_t key[2], std::uint32_t out[4])
+            {
+                // multipliers, and Weyl sequence constants of the key schedule
+                const std::uint32_t m0 = 0xD2511F53u, m1 = 0xCD9E8D57u;
+                const std::uint32_t w0 = 0x9E3779B9u, w1 = 0xBB67AE85u;
+                std::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+                std::uint32_t k0 = key[0], k1 = key[1];
+                for(int round = 0; round < 10; round++)
+                {
+                    std::uint64_t p0 = (std::uint64_t) m0*c0;
+                    std::uint64_t p1 = (std::uint64_t) m1*c2;
+                    c0 = (std::uint32_t) (p1 >> 32) ^ c1 ^ k0;
+                    c1 = (std::uint32_t) p1;
+                    c2 = (std::uint32_t) (p0 >> 32) ^ c3 ^ k1;
+                    c3 = (std::uint32_t) p0;
+                    k0 += w0;
+                    k1 += w1;
+                }
+                out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+            }
+
+        private:
+            /**
+             * @brief Go to the next block, and compute it.
+             */
+            void increment_counter()
+            {
+                if (++counter[0] == 0) ++counter[1];
+                block(counter, key, buffer);
+            }
+
+            std::uint32_t key[2];
+            std::uint32_t counter[4];
+            /**
+             * Outputs of the current counter, and index of the next one in buffer
+             */
+            std::uint32_t buffer[4];
+            int index;
+        };
+
+        /**
+         * @brief Uniform sample in [0, 1) with 53 random bits, from the next two outputs of generator.
+         * @details Cheaper than std::uniform_real_distribution<double>, for code drawing many samples from
+         * Philox4x32 generators (e.g., one generator per slot of a vectorized environment).
+         */
+        inline double uniform(Philox4x32& generator)
+        {
+            std::uint32_t a = generator() >> 5;
+            std::uint32_t b = generator() >> 6;
+            return (a*67108864.0 + b)*(1.0/9007199254740992.0);
+        }
+
         /**
          * @brief Class for random number generation.
+         * @details Engine is the random number generator: std::mt19937 (see Random) or Philox4x32 (see
+         * PhiloxRandom). With std::mt19937, streams are obtained by seeding with a std::seed_seq, and skipping
+         * ahead is linear in the number of skipped values. With Philox4x32, the state is much smaller (44 bytes
+         * instead of 5 KB) and streams and skipping ahead are O(1).
+         * Vectorized code drawing many uniform samples may also use a Philox4x32 directly.
          */
-        class Random
+        template <typename Engine>
+        class BasicRandom
         {
         
         private:
             /**
              * Random number generator
              */
-            std::mt19937 generator;
+            Engine generator;
             /**
              * continuous uniform distribution in (0, 1)
              */ 
@@ -36,7 +154,7 @@ namespace utils
              */
             std::normal_distribution<double> gaussian_dist;
             /**
-             * Seed for the std::mt19937 generator.
+             * Seed of the generator.
              */
             unsigned seed;
 
@@ -45,18 +163,41 @@ namespace utils
              * @brief Initializes object with given seed.
              * @param _seed
              */
-            Random(unsigned _seed = 42);
-            ~Random(){};
+            BasicRandom(unsigned _seed = 42);
+            ~BasicRandom(){};
 
             /**
-             * @brief Set seed for random number generator
+             * @brief Set seed for random number generator, and go back to the beginning of stream 0.
              * @param _seed
              */
             void set_seed(unsigned _seed);
 
+            /**
+             * @brief Go to the beginning of an independent sequence of the current seed.
+             * @details With Philox4x32, each (stream, substream) pair is a distinct counter range, reached in
+             * O(1): e.g., one stream per thread or per copy of an environment, and one substream per episode.
+             * With std::mt19937, the generator is seeded from (seed, stream, substream) with std::seed_seq.
+             * The stream (0, 0) is the sequence obtained after set_seed().
+             * @param _stream
+             * @param _substream
+             */
+            void set_stream(std::uint32_t _stream, std::uint64_t _substream = 0);
+
+            /**
+             * @brief Copy of this object moved to the beginning of another stream of the same seed.
+             */
+            BasicRandom split(std::uint32_t _stream, std::uint64_t _substream = 0) const;
+
+            /**
+             * @brief Skip n outputs of the generator. O(1) with Philox4x32, O(n) with std::mt19937.
+             */
+            void discard(unsigned long long n);
+
             /**
              * @brief Sample according to probability vector.
              * @details The parameter prob is passed by reference to avoid copying. It is not changed by the algorithm.
+             * No memory is allocated, but the cumulative distribution is scanned at each call: to sample many times
+             * from the same distribution, use utils::rand::CategoricalSampler.
              * @param prob probability vector 
              * @param u (optional) sample from a real uniform distribution in (0, 1)
              * @return integer between 0 and prob.size()-1 according to 
@@ -64,6 +205,27 @@ namespace utils
              */
             int choice(std::vector<double>& prob, double u = -1);
 
+            /**
+             * @brief Sample according to the probability array prob[0], ..., prob[n-1].
+             * @details Same as choice(std::vector<double>&, double), for probabilities stored in contiguous
+             * arrays (e.g., rows of a utils::vec::tensor_3d).
+             * @param prob pointer to the first probability
+             * @param n number of probabilities
+             * @param u (optional) sample from a real uniform distribution in (0, 1)
+             * @return integer between 0 and n-1
+             */
+            int choice(const double* prob, int n, double u = -1);
+
+            /**
+             * @brief Sample in O(1) from a distribution represented by an alias table.
+             * @details See build_alias_table(). Uses a single uniform sample and does not allocate memory.
+             * @param alias_prob acceptance probabilities of the table
+             * @param alias_index alias of each entry of the table
+             * @param n size of the table
+             * @return integer between 0 and n-1
+             */
+            int sample_alias(const double* alias_prob, const int* alias_index, int n);
+
             /**
              * @brief Sample from (continuous) uniform distribution in (a, b)
              * @param a 
@@ -79,7 +241,165 @@ namespace utils
              * @return sample
              */
             double sample_gaussian(double mu, double sigma);
+
+            /**
+             * @brief Add independent samples of a zero-mean gaussian distribution to an array.
+             * @param values array of size n, modified in place: values[i] += sigma*standard_gaussian_sample
+             * @param n size of the array
+             * @param sigma standard deviation
+             */
+            void add_gaussian(double* values, int n, double sigma);
         };     
+
+        /**
+         * @brief Random numbers from a Mersenne Twister (std::mt19937), used by the environments and algorithms.
+         */
+        typedef BasicRandom<std::mt19937> Random;
+
+        /**
+         * @brief Random numbers from the counter-based generator Philox4x32.
+         */
+        typedef BasicRandom<Philox4x32> PhiloxRandom;
+
+        // instantiated in random.cpp
+        extern template class BasicRandom<std::mt19937>;
+        extern template class BasicRandom<Philox4x32>;
+
+        /**
+         * @brief Seed used when no seed is given to an environment (seed < 1).
+         * @details The seeds are the outputs of a SplitMix64 generator (see splitmix64()) started from the state
+         * set by set_default_seed() (0 at the beginning of the program), reduced to [1, 2^30 - 1]. Unlike
+         * std::rand(), it can be called from several threads.
+         */
+        int default_seed();
+
+        /**
+         * @brief Restart the sequence of seeds returned by default_seed() from the state seed.
+         */
+        void set_default_seed(std::uint64_t seed);
+
+        /**
+         * @brief Sampler for a fixed categorical distribution over {0, ..., n-1}.
+         * @details The cumulative distribution function is computed once, when the probabilities are set. Samples
+         * are then obtained by a linear scan (n <= linear_search_max) or a branch-free binary search, without
+         * allocating memory. For a uniform sample u, sample(u) returns the same value as Random::choice(prob, u).
+         */
+        class CategoricalSampler
+        {
+        public:
+            /**
+             * @brief Default constructor. Builds a sampler with no categories.
+             */
+            CategoricalSampler() {};
+
+            /**
+             * @param prob probability vector
+             */
+            CategoricalSampler(const std::vector<double>& prob);
+
+            /**
+             * @param prob pointer to the first probability
+             * @param n number of probabilities
+             */
+            CategoricalSampler(const double* prob, int n);
+
+            /**
+             * @brief Set the probabilities and recompute the cumulative distribution function.
+             * @details Memory is only allocated if n is larger than the size of any previous distribution.
+             * @param prob pointer to the first probability
+             * @param n number of probabilities
+             */
+            void set_prob(const double* prob, int n);
+
+            /**
+             * @brief Get the category corresponding to a uniform sample.
+             * @param u sample from a real uniform distribution in (0, 1)
+             * @return smallest i such that u <= prob[0] + ... + prob[i], or -1 if there is none.
+             */
+            int sample(double u) const;
+
+            /**
+             * @brief Sample a category.
+             * @param randgen random number generator
+             * @return integer between 0 and size()-1
+             */
+            template <typename Engine>
+            int sample(BasicRandom<Engine>& randgen) const
+            {
+                return sample(randgen.sample_real_uniform(0, 1));
+            }
+
+            /**
+             * @brief Draw count independent samples.
+             * @param out array of size count in which the samples are stored
+             * @param count number of samples
+             * @param randgen random number generator
+             */
+            template <typename Engine>
+            void sample_n(int* out, int count, BasicRandom<Engine>& randgen) const
+            {
+                for(int i = 0; i < count; i++)
+                {
+                    out[i] = sample(randgen.sample_real_uniform(0, 1));
+                }
+            }
+
+            /**
+             * @brief Number of categories
+             */
+            int size() const { return n; }
+
+            /**
+             * Distributions with at most linear_search_max categories are sampled with a linear scan.
+             */
+            static constexpr int linear_search_max = 8;
+
+        private:
+            /**
+             * Cumulative distribution function
+             */
+            std::vector<double> cdf;
+
+            /**
+             * Number of categories
+             */
+            int n = 0;
+        };
+
+        /**
+         * @brief Build the alias table (Walker/Vose method) of the distribution prob[0], ..., prob[n-1].
+         * @details Sampling i uniformly in {0, ..., n-1} and returning i with probability alias_prob[i], and
+         * alias_index[i] otherwise, gives a sample from prob. The probabilities are normalized by their sum.
+         * @param prob pointer to the first probability
+         * @param n number of probabilities
+         * @param alias_prob output array of size n
+         * @param alias_index output array of size n
+         */
+        void build_alias_table(const double* prob, int n, double* alias_prob, int* alias_index);
+
+        /**
+         * @brief Output number k of the SplitMix64 generator started from the state seed.
+         * @details The output is computed directly from (seed, k), without any generator state: it can be called
+         * from several threads and in any order, and always returns the same value for the same (seed, k).
+         * @param seed initial state of the generator
+         * @param k index of the output
+         * @return 64 random bits
+         */
+        inline std::uint64_t splitmix64(std::uint64_t seed, std::uint64_t k)
+        {
+            std::uint64_t z = seed + (k + 1)*0x9e3779b97f4a7c15ULL;
+            z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27))*0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        /**
+         * @brief Uniform sample in [0, 1) given by the 53 high bits of splitmix64(seed, k).
+         */
+        inline double hashed_uniform(std::uint64_t seed, std::uint64_t k)
+        {
+            return (splitmix64(seed, k) >> 11)*(1.0/9007199254740992.0);
+        }
     }
 }
 #endif
\ No newline at end of file
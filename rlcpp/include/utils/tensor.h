@@ -0,0 +1,266 @@
+#ifndef __TENSOR_H__
+#define __TENSOR_H__
+
+/**
+ * @file
+ * @brief Contiguous, aligned multidimensional arrays.
+ */
+
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <assert.h>
+
+namespace utils
+{
+    namespace vec
+    {
+        /**
+         * @brief Allocator returning memory aligned to Alignment bytes.
+         * @details Used by Tensor3d so that each row starts on a cache line (and on a SIMD register boundary).
+         * @tparam T type of the elements
+         * @tparam Alignment alignment in bytes, must be a power of two multiple of sizeof(void*)
+         */
+        template <typename T, std::size_t Alignment = 64>
+        class AlignedAllocator
+        {
+        public:
+            typedef T value_type;
+
+            template <typename U>
+            struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+            AlignedAllocator() {};
+            template <typename U>
+            AlignedAllocator(const AlignedAllocator<U, Alignment>&) {};
+
+            T* allocate(std::size_t n)
+            {
+                if (n == 0) return nullptr;
+                void* ptr = nullptr;
+                if (posix_memalign(&ptr, Alignment, n*sizeof(T)) != 0) throw std::bad_alloc();
+                return static_cast<T*>(ptr);
+            }
+
+            void deallocate(T* ptr, std::size_t) { std::free(ptr); }
+
+            template <typename U>
+            bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+            template <typename U>
+            bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+        };
+
+        /**
+         * @brief Non-owning view of a contiguous row of a tensor.
+         * @tparam U type of the elements (possibly const)
+         */
+        template <typename U>
+        class RowView
+        {
+        public:
+            RowView(U* _ptr, int _n): ptr(_ptr), n(_n) {};
+
+            /**
+             * @brief Conversion from a mutable view to a const view.
+             */
+            template <typename V, typename = typename std::enable_if<std::is_convertible<V*, U*>::value>::type>
+            RowView(const RowView<V>& other): ptr(other.data()), n(other.size()) {};
+
+            U& operator[](int i) const { return ptr[i]; }
+
+            /**
+             * @brief Number of elements in the row
+             */
+            int size() const { return n; }
+
+            /**
+             * @brief Pointer to the first element of the row
+             */
+            U* data() const { return ptr; }
+
+            U* begin() const { return ptr; }
+            U* end() const { return ptr + n; }
+
+            /**
+             * @brief Copy the row into a std::vector
+             */
+            std::vector<typename std::remove_const<U>::type> to_vector() const
+            {
+                return std::vector<typename std::remove_const<U>::type>(ptr, ptr + n);
+            }
+
+        private:
+            U* ptr;
+            int n;
+        };
+
+        /**
+         * @brief Non-owning view of a 2d slice tensor[i] of a Tensor3d.
+         * @details Allows the nested-vector syntax tensor[i][j][k].
+         */
+        template <typename U>
+        class SliceView
+        {
+        public:
+            SliceView(U* _ptr, int _n_rows, int _n_cols, std::size_t _stride):
+                ptr(_ptr), n_rows(_n_rows), n_cols(_n_cols), stride(_stride) {};
+
+            RowView<U> operator[](int j) const { return RowView<U>(ptr + j*stride, n_cols); }
+
+            /**
+             * @brief Number of rows in the slice
+             */
+            int size() const { return n_rows; }
+
+        private:
+            U* ptr;
+            int n_rows;
+            int n_cols;
+            std::size_t stride;
+        };
+
+        /**
+         * @brief 3d array of dimensions (dim1, dim2, dim3) stored in a single aligned block.
+         * @details Element (i, j, k) is stored at offset (i*dim2 + j)*row_stride() + k. Each row (i, j) is padded
+         * to a multiple of 64 bytes so that every row starts on an aligned address; the padding is filled with zeros.
+         * A Tensor3d can be built from (and converted to) a nested std::vector, and supports the nested syntax
+         * tensor[i][j][k] through lightweight views. In hot loops, prefer row(i, j) or operator()(i, j, k).
+         * @tparam T type of the elements
+         */
+        template <typename T>
+        class Tensor3d
+        {
+        public:
+            /**
+             * @brief Default constructor. Builds an empty tensor.
+             */
+            Tensor3d(): d1(0), d2(0), d3(0), stride(0) {};
+
+            /**
+             * @brief Build tensor of dimensions (dim1, dim2, dim3) filled with value.
+             */
+            Tensor3d(int dim1, int dim2, int dim3, T value = T())
+            {
+                resize(dim1, dim2, dim3, value);
+            }
+
+            /**
+             * @brief Build tensor from a nested vector (conversion path from utils::vec::vec_3d and ivec_3d).
+             * @param nested nested vector of dimensions (dim1, dim2, dim3). All rows must have the same length.
+             */
+            Tensor3d(const std::vector<std::vector<std::vector<T>>>& nested)
+            {
+                int dim1 = nested.size();
+                int dim2 = (dim1 > 0) ? nested[0].size() : 0;
+                int dim3 = (dim2 > 0) ? nested[0][0].size() : 0;
+                resize(dim1, dim2, dim3);
+                for(int i = 0; i < d1; i++)
+                {
+                    assert(nested[i].size() == (std::size_t) d2 && "Nested vector is not rectangular");
+                    for(int j = 0; j < d2; j++)
+                    {
+                        assert(nested[i][j].size() == (std::size_t) d3 && "Nested vector is not rectangular");
+                        T* dst = row(i, j).data();
+                        for(int k = 0; k < d3; k++) dst[k] = nested[i][j][k];
+                    }
+                }
+            }
+
+            /**
+             * @brief Change dimensions and set all elements to value.
+             */
+            void resize(int dim1, int dim2, int dim3, T value = T())
+            {
+                assert(dim1 >= 0 && dim2 >= 0 && dim3 >= 0);
+                d1 = dim1;
+                d2 = dim2;
+                d3 = dim3;
+                const std::size_t per_line = (64 >= sizeof(T)) ? 64/sizeof(T) : 1;
+                stride = ((d3 + per_line - 1)/per_line)*per_line;
+                values.assign(((std::size_t) d1)*d2*stride, T());
+                if (value != T()) fill(value);
+            }
+
+            /**
+             * @brief Set all elements (excluding padding) to value.
+             */
+            void fill(T value)
+            {
+                for(int i = 0; i < d1; i++)
+                    for(int j = 0; j < d2; j++)
+                    {
+                        T* dst = row(i, j).data();
+                        for(int k = 0; k < d3; k++) dst[k] = value;
+                    }
+            }
+
+            T& operator()(int i, int j, int k) { return values[offset(i, j) + k]; }
+            const T& operator()(int i, int j, int k) const { return values[offset(i, j) + k]; }
+
+            SliceView<T> operator[](int i) { return SliceView<T>(values.data() + offset(i, 0), d2, d3, stride); }
+            SliceView<const T> operator[](int i) const { return SliceView<const T>(values.data() + offset(i, 0), d2, d3, stride); }
+
+            /**
+             * @brief View of the (aligned) row tensor[i][j]
+             */
+            RowView<T> row(int i, int j) { return RowView<T>(values.data() + offset(i, j), d3); }
+            RowView<const T> row(int i, int j) const { return RowView<const T>(values.data() + offset(i, j), d3); }
+
+            /**
+             * @brief Pointer to the underlying storage (including padding).
+             */
+            T* data() { return values.data(); }
+            const T* data() const { return values.data(); }
+
+            /**
+             * @brief Size of the first dimension (same as size(), for compatibility with nested vectors)
+             */
+            int dim1() const { return d1; }
+            int dim2() const { return d2; }
+            int dim3() const { return d3; }
+            int size() const { return d1; }
+            bool empty() const { return values.empty(); }
+
+            /**
+             * @brief Distance, in elements, between the first elements of two consecutive rows.
+             */
+            std::size_t row_stride() const { return stride; }
+
+            /**
+             * @brief Convert to nested vector
+             */
+            std::vector<std::vector<std::vector<T>>> to_nested() const
+            {
+                std::vector<std::vector<std::vector<T>>> nested(d1, std::vector<std::vector<T>>(d2));
+                for(int i = 0; i < d1; i++)
+                    for(int j = 0; j < d2; j++)
+                        nested[i][j] = row(i, j).to_vector();
+                return nested;
+            }
+
+        private:
+            std::size_t offset(int i, int j) const
+            {
+                return (((std::size_t) i)*d2 + j)*stride;
+            }
+
+            int d1, d2, d3;
+            std::size_t stride;
+            std::vector<T, AlignedAllocator<T>> values;
+        };
+
+        /**
+         * @brief Type for contiguous 3d array (double)
+         */
+        typedef Tensor3d<double> tensor_3d;
+
+        /**
+         * @brief Type for contiguous 3d array (integer)
+         */
+        typedef Tensor3d<int> itensor_3d;
+    }
+}
+
+#endif
@@ -1,7 +1,11 @@
 #ifndef __UTILS_H__
 #define __UTILS_H__
 
+#include <cstddef>
+#include <assert.h>
 #include "vector_op.h"
+#include "tensor.h"
+#include "parallel.h"
 #include "random.h"
 
 /**
@@ -30,6 +34,30 @@ namespace utils
         assert( !(hi < lo) );
         return (v < lo) ? lo : (hi < v) ? hi : v;
     }
+
+    // this should be defined in C++20
+    /**
+     * @brief View of a contiguous array that it does not own, like std::span.
+     * @tparam T type of the elements (const T for a read-only view)
+     */
+    template<class T>
+    class Span
+    {
+    public:
+        Span(): ptr(nullptr), n(0) {}
+        Span(T* _ptr, std::size_t _n): ptr(_ptr), n(_n) {}
+
+        T* data() const { return ptr; }
+        std::size_t size() const { return n; }
+        bool empty() const { return n == 0; }
+        T& operator[](std::size_t i) const { return ptr[i]; }
+        T* begin() const { return ptr; }
+        T* end() const { return ptr + n; }
+
+    private:
+        T* ptr;
+        std::size_t n;
+    };
 }
 
 #endif
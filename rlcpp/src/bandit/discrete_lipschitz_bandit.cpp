@@ -9,7 +9,7 @@ namespace bandit
                                                      double _sigma,
                                                      int _seed /* = -1 */)
     {
-        if (_seed < 1) _seed = std::rand();
+        if (_seed < 1) _seed = utils::rand::default_seed();
         F = &_F;
         L = _L; 
         sigma = _sigma;
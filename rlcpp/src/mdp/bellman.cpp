@@ -0,0 +1,294 @@
+#include <algorithm>
+#include "bellman.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define RLCPP_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+/*
+    Each kernel has a scalar implementation and, on x86 processors, AVX2 and AVX-512 implementations compiled
+    with function-specific target attributes. The implementation is chosen once, at the first call.
+*/
+
+namespace mdp
+{
+namespace bellman
+{
+namespace
+{
+    /**
+     * Number of entries whose terms are computed at once by the sparse kernels.
+     */
+    constexpr int block_size = 64;
+
+    typedef double (*count_kernel)(const int*, const int*, const double*, int);
+    typedef void (*moments_kernel)(const int*, const int*, const double*, int, double, double*, double*);
+    typedef void (*terms_kernel)(const double*, const double*, const int*, const double*, double, int, double*);
+
+    // -------------------------------------------------------------------------------------------------
+    // Scalar kernels
+    // -------------------------------------------------------------------------------------------------
+
+    double count_scalar(const int* counts, const int* indices, const double* v, int n)
+    {
+        double sum = 0;
+        for(int k = 0; k < n; k++) sum += counts[k]*v[indices[k]];
+        return sum;
+    }
+
+    void moments_scalar(const int* counts, const int* indices, const double* v, int n, double shift,
+                        double* sum, double* sum_squares)
+    {
+        double s1 = 0, s2 = 0;
+        for(int k = 0; k < n; k++)
+        {
+            double x = v[indices[k]] - shift;
+            s1 += counts[k]*x;
+            s2 += counts[k]*x*x;
+        }
+        *sum = s1;
+        *sum_squares = s2;
+    }
+
+    /**
+     * out[k] = p[k]*(r[k] + gamma*v[next_states[k]])
+     */
+    void terms_scalar(const double* p, const double* r, const int* next_states, const double* v, double gamma,
+                      int n, double* out)
+    {
+        for(int k = 0; k < n; k++) out[k] = p[k]*(r[k] + gamma*v[next_states[k]]);
+    }
+
+#ifdef RLCPP_X86_SIMD
+    // -------------------------------------------------------------------------------------------------
+    // AVX2 kernels
+    // -------------------------------------------------------------------------------------------------
+
+    __attribute__((target("avx2,fma")))
+    double count_avx2(const int* counts, const int* indices, const double* v, int n)
+    {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        int k = 0;
+        for(; k + 8 <= n; k += 8)
+        {
+            __m128i i0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + k));
+            __m128i i1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + k + 4));
+            __m256d c0 = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(counts + k)));
+            __m256d c1 = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(counts + k + 4)));
+            acc0 = _mm256_fmadd_pd(c0, _mm256_i32gather_pd(v, i0, 8), acc0);
+            acc1 = _mm256_fmadd_pd(c1, _mm256_i32gather_pd(v, i1, 8), acc1);
+        }
+        acc0 = _mm256_add_pd(acc0, acc1);
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+        double sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+        return sum + count_scalar(counts + k, indices + k, v, n - k);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void moments_avx2(const int* counts, const int* indices, const double* v, int n, double shift,
+                      double* sum, double* sum_squares)
+    {
+        __m256d shift4 = _mm256_set1_pd(shift);
+        __m256d acc1 = _mm256_setzero_pd();
+        __m256d acc2 = _mm256_setzero_pd();
+        int k = 0;
+        for(; k + 4 <= n; k += 4)
+        {
+            __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + k));
+            __m256d c = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(counts + k)));
+            __m256d x = _mm256_sub_pd(_mm256_i32gather_pd(v, index, 8), shift4);
+            __m256d cx = _mm256_mul_pd(c, x);
+            acc1 = _mm256_add_pd(acc1, cx);
+            acc2 = _mm256_fmadd_pd(cx, x, acc2);
+        }
+        double tail1, tail2;
+        moments_scalar(counts + k, indices + k, v, n - k, shift, &tail1, &tail2);
+        __m128d half1 = _mm_add_pd(_mm256_castpd256_pd128(acc1), _mm256_extractf128_pd(acc1, 1));
+        __m128d half2 = _mm_add_pd(_mm256_castpd256_pd128(acc2), _mm256_extractf128_pd(acc2, 1));
+        *sum = _mm_cvtsd_f64(_mm_add_sd(half1, _mm_unpackhi_pd(half1, half1))) + tail1;
+        *sum_squares = _mm_cvtsd_f64(_mm_add_sd(half2, _mm_unpackhi_pd(half2, half2))) + tail2;
+    }
+
+    __attribute__((target("avx2")))
+    void terms_avx2(const double* p, const double* r, const int* next_states, const double* v, double gamma,
+                    int n, double* out)
+    {
+        __m256d g = _mm256_set1_pd(gamma);
+        int k = 0;
+        for(; k + 4 <= n; k += 4)
+        {
+            __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i*>(next_states + k));
+            __m256d x = _mm256_add_pd(_mm256_loadu_pd(r + k), _mm256_mul_pd(g, _mm256_i32gather_pd(v, index, 8)));
+            _mm256_storeu_pd(out + k, _mm256_mul_pd(_mm256_loadu_pd(p + k), x));
+        }
+        // remaining entries
+        terms_scalar(p + k, r + k, next_states + k, v, gamma, n - k, out + k);
+    }
+
+    // -------------------------------------------------------------------------------------------------
+    // AVX-512 kernels
+    // -------------------------------------------------------------------------------------------------
+
+    __attribute__((target("avx512f")))
+    double count_avx512(const int* counts, const int* indices, const double* v, int n)
+    {
+        __m512d acc0 = _mm512_setzero_pd();
+        __m512d acc1 = _mm512_setzero_pd();
+        int k = 0;
+        for(; k + 16 <= n; k += 16)
+        {
+            __m256i i0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + k));
+            __m256i i1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + k + 8));
+            __m512d c0 = _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts + k)));
+            __m512d c1 = _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts + k + 8)));
+            acc0 = _mm512_fmadd_pd(c0, _mm512_i32gather_pd(i0, v, 8), acc0);
+            acc1 = _mm512_fmadd_pd(c1, _mm512_i32gather_pd(i1, v, 8), acc1);
+        }
+        for(; k + 8 <= n; k += 8)
+        {
+            __m256i i0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + k));
+            __m512d c0 = _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts + k)));
+            acc0 = _mm512_fmadd_pd(c0, _mm512_i32gather_pd(i0, v, 8), acc0);
+        }
+        return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1)) + count_scalar(counts + k, indices + k, v, n - k);
+    }
+
+    __attribute__((target("avx512f")))
+    void moments_avx512(const int* counts, const int* indices, const double* v, int n, double shift,
+                        double* sum, double* sum_squares)
+    {
+        __m512d shift8 = _mm512_set1_pd(shift);
+        __m512d acc1 = _mm512_setzero_pd();
+        __m512d acc2 = _mm512_setzero_pd();
+        int k = 0;
+        for(; k + 8 <= n; k += 8)
+        {
+            __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + k));
+            __m512d c = _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts + k)));
+            __m512d x = _mm512_sub_pd(_mm512_i32gather_pd(index, v, 8), shift8);
+            __m512d cx = _mm512_mul_pd(c, x);
+            acc1 = _mm512_add_pd(acc1, cx);
+            acc2 = _mm512_fmadd_pd(cx, x, acc2);
+        }
+        double tail1, tail2;
+        moments_scalar(counts + k, indices + k, v, n - k, shift, &tail1, &tail2);
+        *sum = _mm512_reduce_add_pd(acc1) + tail1;
+        *sum_squares = _mm512_reduce_add_pd(acc2) + tail2;
+    }
+
+    __attribute__((target("avx512f")))
+    void terms_avx512(const double* p, const double* r, const int* next_states, const double* v, double gamma,
+                      int n, double* out)
+    {
+        __m512d g = _mm512_set1_pd(gamma);
+        int k = 0;
+        for(; k + 8 <= n; k += 8)
+        {
+            __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(next_states + k));
+            __m512d x = _mm512_add_pd(_mm512_loadu_pd(r + k), _mm512_mul_pd(g, _mm512_i32gather_pd(index, v, 8)));
+            _mm512_storeu_pd(out + k, _mm512_mul_pd(_mm512_loadu_pd(p + k), x));
+        }
+        // remaining entries
+        terms_scalar(p + k, r + k, next_states + k, v, gamma, n - k, out + k);
+    }
+#endif
+
+    // -------------------------------------------------------------------------------------------------
+    // Dispatch
+    // -------------------------------------------------------------------------------------------------
+
+    struct Kernels
+    {
+        count_kernel count;
+        moments_kernel moments;
+        terms_kernel terms;
+        std::string name;
+    };
+
+    Kernels scalar_kernels()
+    {
+        return Kernels{count_scalar, moments_scalar, terms_scalar, "scalar"};
+    }
+
+    Kernels best_kernels()
+    {
+#ifdef RLCPP_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return Kernels{count_avx512, moments_avx512, terms_avx512, "avx512"};
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return Kernels{count_avx2, moments_avx2, terms_avx2, "avx2"};
+#endif
+        return scalar_kernels();
+    }
+
+    Kernels& kernels()
+    {
+        static Kernels selected = best_kernels();
+        return selected;
+    }
+}
+
+    double weighted_sum(const int* counts, const int* indices, const double* v, int n)
+    {
+        return kernels().count(counts, indices, v, n);
+    }
+
+    void weighted_moments(const int* counts, const int* indices, const double* v, int n, double shift,
+                          double* sum, double* sum_squares)
+    {
+        kernels().moments(counts, indices, v, n, shift, sum, sum_squares);
+    }
+
+    double expected_value(const double* p, const double* r, const int* next_states, const double* v, int n,
+                          double gamma /* = 1.0 */)
+    {
+        terms_kernel terms = kernels().terms;
+        double buffer[block_size];
+        double sum = 0;
+        for(int b = 0; b < n; b += block_size)
+        {
+            int m = std::min(block_size, n - b);
+            terms(p + b, r + b, next_states + b, v, gamma, m, buffer);
+            for(int k = 0; k < m; k++) sum += buffer[k];
+        }
+        return sum;
+    }
+
+    void backup_state(const SparseTransitions& P, int s, const double* v, double* q, double gamma /* = 1.0 */)
+    {
+        terms_kernel terms = kernels().terms;
+        const int* row_ptr = P.row_ptr().data() + s*P.na;
+        int begin = row_ptr[0];
+        int end = row_ptr[P.na];
+
+        // The rows of all actions of s are contiguous: compute the terms of the whole segment by blocks,
+        // and accumulate each term in the value of its action.
+        double buffer[block_size];
+        int a = 0;
+        for(int action = 0; action < P.na; action++) q[action] = 0;
+        for(int b = begin; b < end; b += block_size)
+        {
+            int m = std::min(block_size, end - b);
+            terms(P.probs().data() + b, P.rewards().data() + b, P.next_states().data() + b, v, gamma, m, buffer);
+            for(int k = 0; k < m; k++)
+            {
+                while (b + k >= row_ptr[a + 1]) a++;
+                q[a] += buffer[k];
+            }
+        }
+    }
+
+    std::string instruction_set()
+    {
+        return kernels().name;
+    }
+
+    void use_simd(bool enable)
+    {
+        kernels() = enable ? best_kernels() : scalar_kernels();
+    }
+}
+}
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <utility>
 #include "chain.h"
 #include "utils.h"
 
@@ -8,8 +9,7 @@ namespace mdp
     Chain::Chain(int N, double fail_p)
     {
         assert(N > 0 && "Chain needs at least one state");
-        utils::vec::vec_3d _rewards = utils::vec::get_zeros_3d(N, 2, N);
-        utils::vec::vec_3d _transitions = utils::vec::get_zeros_3d(N, 2, N);
+        SparseTransitions _transitions(N, 2, 4*N);
         std::vector<int> _terminal_states = {N-1};
 
         for(int state = 0; state < N; state++)
@@ -27,16 +27,15 @@ namespace mdp
                 {
                     next_state = std::max(state - 1, 0);
                 }
-                _transitions[state][action][next_state] = 1.0 - fail_p;
-                _transitions[state][action][state] += fail_p;
-                if (next_state == N-1)
-                {
-                    _rewards[state][action][next_state] = 1.0;
-                }
+                // A reward of 1 is obtained when the next state is N-1 (and is not reached by failure)
+                double reward = (next_state == N-1) ? 1.0 : 0.0;
+                _transitions.add(next_state, 1.0 - fail_p, reward);
+                _transitions.add(state, fail_p, (state == next_state) ? reward : 0.0);
+                _transitions.end_row();
             }
         }
 
-        set_params(_rewards, _transitions, _terminal_states);
+        set_params(DiscreteReward(), std::move(_transitions), _terminal_states);
         id = "Chain";
     }
 }
@@ -1,41 +1,72 @@
+#include <utility>
+#include <stdexcept>
 #include "discrete_reward.h"
 
 namespace mdp
 {
     DiscreteReward::DiscreteReward()
     {
-        noise_type = "none";
+        set_noise("none", std::vector<double>());
     }
 
-    DiscreteReward::DiscreteReward(utils::vec::vec_3d _mean_rewards)
+    DiscreteReward::DiscreteReward(utils::vec::tensor_3d _mean_rewards)
     {
-        mean_rewards = _mean_rewards;
-        noise_type = "none";
+        mean_rewards = std::move(_mean_rewards);
+        set_noise("none", std::vector<double>());
     }
 
-    DiscreteReward::DiscreteReward(utils::vec::vec_3d _mean_rewards, std::string _noise_type, std::vector<double> _noise_params)
+    DiscreteReward::DiscreteReward(const utils::vec::vec_3d& _mean_rewards):
+        DiscreteReward(utils::vec::tensor_3d(_mean_rewards))
     {
-        mean_rewards = _mean_rewards;
-        noise_type = _noise_type;
-        noise_params = _noise_params;
     }
 
-    double DiscreteReward::sample(int state, int action, int next_state, utils::rand::Random randgen)
+    DiscreteReward::DiscreteReward(utils::vec::tensor_3d _mean_rewards, std::string _noise_type, std::vector<double> _noise_params)
+    {
+        mean_rewards = std::move(_mean_rewards);
+        set_noise(_noise_type, _noise_params);
+    }
+
+    DiscreteReward::DiscreteReward(const utils::vec::vec_3d& _mean_rewards, std::string _noise_type, std::vector<double> _noise_params):
+        DiscreteReward(utils::vec::tensor_3d(_mean_rewards), _noise_type, _noise_params)
+    {
+    }
+
+    DiscreteReward::DiscreteReward(std::string _noise_type, std::vector<double> _noise_params)
+    {
+        set_noise(_noise_type, _noise_params);
+    }
+
+    void DiscreteReward::set_noise(std::string _noise_type, std::vector<double> _noise_params)
     {
-        double mean_r = mean_rewards[state][action][next_state];
-        double noise;
+        noise_type = _noise_type;
+        noise_params = _noise_params;
         if (noise_type == "none")
-            noise = 0;
+            noise = none;
         else if(noise_type == "gaussian")
         {
             assert(noise_params.size() == 1 && "noise type and noise params are not compatible");
-            noise = randgen.sample_gaussian(0, noise_params[0]);
+            noise = gaussian;
         }
         else
         {
             std::cerr << "Invalid noise type in DiscreteReward" << std::endl;
-        }        
-        return mean_r + noise;
+            noise = none;
+        }
+    }
+
+    double DiscreteReward::sample(int state, int action, int next_state, utils::rand::Random& randgen)
+    {
+        if (mean_rewards.empty())
+        {
+            throw std::logic_error("DiscreteReward::sample(): no mean rewards (they are stored in the transitions of "
+                                   "a FiniteMDP, use sample_noise())");
+        }
+        return mean_rewards(state, action, next_state) + sample_noise(randgen);
     }
 
-}
\ No newline at end of file
+    void DiscreteReward::add_noise(double* rewards, int count, utils::rand::Random& randgen)
+    {
+        if (noise == none) return;
+        randgen.add_gaussian(rewards, count, noise_params[0]);
+    }
+}
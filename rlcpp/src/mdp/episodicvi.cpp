@@ -1,70 +1,87 @@
 #include <algorithm>
 #include <cmath>
 #include "episodicvi.h"
+#include "bellman.h"
 
 namespace mdp
 {
 EpisodicVI::EpisodicVI(FiniteMDP& mdp, int horizon) :
-    mdp(mdp), horizon(horizon)
+    mdp(mdp), horizon(horizon), schedule(utils::parallel::static_schedule), chunk_size(0)
 {
 }
 
+void EpisodicVI::set_num_threads(int n_threads,
+                                 utils::parallel::schedule_type _schedule /* = static_schedule */,
+                                 int _chunk_size /* = 0 */)
+{
+    schedule = _schedule;
+    chunk_size = _chunk_size;
+    if (n_threads == 1)
+        pool.reset();
+    else
+        pool = std::make_shared<utils::parallel::ThreadPool>(n_threads);
+}
 
 void EpisodicVI::run()
 {
-    Q = utils::vec::get_zeros_3d(horizon + 1, mdp.ns, mdp.na);
+    Q = utils::vec::tensor_3d(horizon + 1, mdp.ns, mdp.na);
     greedy_policy = utils::vec::get_zeros_i2d(horizon, mdp.ns);
     V = utils::vec::get_zeros_2d(horizon + 1, mdp.ns);
 
-    utils::vec::vec_3d& P = mdp.transitions;
-    utils::vec::vec_3d& R = mdp.reward_function.mean_rewards;
-    double tmp;
-
     for(int h=horizon-1; h>=0; h--)
     {
-        for (int s=0; s < mdp.ns; s++)
-        {
-            for (int a=0; a < mdp.na; a++)
-            {
-                tmp = 0;
-                for (int sn=0; sn < mdp.ns; sn++)
-                {
-                    tmp +=  P[s][a][sn] *(R[s][a][sn] + V[h+1][sn]);
-                }
-                Q[h][s][a] = tmp;
+        if (pool)
+            pool->parallel_for(0, mdp.ns, [this, h](int lo, int hi) { backup_states(h, lo, hi); }, schedule, chunk_size);
+        else
+            backup_states(h, 0, mdp.ns);
+    }
+}
 
-                if ((a ==0) || (tmp > V[h][s]))
-                {
-                    V[h][s] = tmp;
-                    greedy_policy[h][s] = a;
-                }
+void EpisodicVI::backup_states(int h, int s_begin, int s_end)
+{
+    const double* v = V[h+1].data();
 
+    for (int s=s_begin; s < s_end; s++)
+    {
+        double* q = &Q(h, s, 0);
+        bellman::backup_state(mdp.transitions, s, v, q);
+        for (int a=0; a < mdp.na; a++)
+        {
+            if ((a ==0) || (q[a] > V[h][s]))
+            {
+                V[h][s] = q[a];
+                greedy_policy[h][s] = a;
             }
         }
     }
 }
 
-void EpisodicVI::evaluate_policy(utils::vec::ivec_2d pi, utils::vec::vec_2d& Vpi)
+void EpisodicVI::evaluate_policy(const utils::vec::ivec_2d& pi, utils::vec::vec_2d& Vpi)
 {
-    utils::vec::vec_3d& P = mdp.transitions;
-    utils::vec::vec_3d& R = mdp.reward_function.mean_rewards;
-
     for (int s=0; s < mdp.ns; ++s) Vpi[horizon][s] = 0;
 
     for(int h=horizon-1; h>=0; h--)
     {
-        for (int s=0; s < mdp.ns; s++)
-        {
-            int a = pi[h][s];
-            double tmp = 0;
-            for (int sn=0; sn < mdp.ns; sn++)
-            {
-                tmp +=  P[s][a][sn] *(R[s][a][sn] + Vpi[h+1][sn]);
-            }
-
-            Vpi[h][s] = tmp;
-        }
+        if (pool)
+            pool->parallel_for(0, mdp.ns, [&, h](int lo, int hi) { evaluate_states(pi, Vpi, h, lo, hi); }, schedule, chunk_size);
+        else
+            evaluate_states(pi, Vpi, h, 0, mdp.ns);
     }
+}
+
+void EpisodicVI::evaluate_states(const utils::vec::ivec_2d& pi, utils::vec::vec_2d& Vpi, int h, int s_begin, int s_end)
+{
+    const SparseTransitions& P = mdp.transitions;
+    const int* next_states = P.next_states().data();
+    const double* probs = P.probs().data();
+    const double* rewards = P.rewards().data();
+    const double* v = Vpi[h+1].data();
 
+    for (int s=s_begin; s < s_end; s++)
+    {
+        int a = pi[h][s];
+        int k = P.row_begin(s, a);
+        Vpi[h][s] = bellman::expected_value(probs + k, rewards + k, next_states + k, v, P.row_end(s, a) - k);
+    }
 }
 }
@@ -2,31 +2,66 @@
 #include <iostream>
 #include <string>
 #include <cmath>
+#include <utility>
+#include <stdexcept>
 #include "finitemdp.h"
 
 namespace mdp
 {
-    FiniteMDP::FiniteMDP(DiscreteReward _reward_function, utils::vec::vec_3d _transitions, int _default_state /* = 0 */, int _seed /* = -1 */)
+    FiniteMDP::FiniteMDP(DiscreteReward _reward_function, utils::vec::tensor_3d _transitions, int _default_state /* = 0 */, int _seed /* = -1 */)
     {
-        set_params(_reward_function, _transitions, _default_state, _seed);
+        set_params(std::move(_reward_function), std::move(_transitions), _default_state, _seed);
     }
 
-    FiniteMDP::FiniteMDP(DiscreteReward _reward_function, utils::vec::vec_3d _transitions, std::vector<int> _terminal_states, int _default_state /* = 0 */, int _seed /* = -1 */)
+    FiniteMDP::FiniteMDP(DiscreteReward _reward_function, utils::vec::tensor_3d _transitions, std::vector<int> _terminal_states, int _default_state /* = 0 */, int _seed /* = -1 */)
     {
-        set_params(_reward_function, _transitions, _terminal_states, _default_state, _seed);
+        set_params(std::move(_reward_function), std::move(_transitions), _terminal_states, _default_state, _seed);
     }
 
-    void FiniteMDP::set_params(DiscreteReward _reward_function, utils::vec::vec_3d _transitions, int _default_state /* = 0 */, int _seed /* = -1 */)
+    FiniteMDP::FiniteMDP(DiscreteReward _reward_function, SparseTransitions _transitions, int _default_state /* = 0 */, int _seed /* = -1 */)
     {
-        reward_function = _reward_function;
-        transitions = _transitions;
+        set_params(std::move(_reward_function), std::move(_transitions), _default_state, _seed);
+    }
+
+    FiniteMDP::FiniteMDP(DiscreteReward _reward_function, SparseTransitions _transitions, std::vector<int> _terminal_states, int _default_state /* = 0 */, int _seed /* = -1 */)
+    {
+        set_params(std::move(_reward_function), std::move(_transitions), _terminal_states, _default_state, _seed);
+    }
+
+    void FiniteMDP::set_params(DiscreteReward _reward_function, utils::vec::tensor_3d _transitions, int _default_state /* = 0 */, int _seed /* = -1 */)
+    {
+        assert(_transitions.dim1() > 0 && _transitions.dim2() > 0);
+        SparseTransitions sparse_transitions(_transitions, _reward_function.mean_rewards);
+        // The mean rewards are now stored in sparse_transitions.
+        _reward_function.mean_rewards = utils::vec::tensor_3d();
+        set_params(std::move(_reward_function), std::move(sparse_transitions), _default_state, _seed);
+    }
+
+    void FiniteMDP::set_params(DiscreteReward _reward_function, utils::vec::tensor_3d _transitions, std::vector<int> _terminal_states, int _default_state /* = 0 */, int _seed /* = -1 */)
+    {
+        set_params(std::move(_reward_function), std::move(_transitions), _default_state, _seed);
+        set_terminal_states(_terminal_states);
+    }
+
+    void FiniteMDP::set_params(DiscreteReward _reward_function, SparseTransitions _transitions, int _default_state /* = 0 */, int _seed /* = -1 */)
+    {
+        if (!_reward_function.mean_rewards.empty())
+        {
+            // they would be ignored: the mean rewards are those of the sparse transitions
+            throw std::invalid_argument("FiniteMDP: the reward function must not have mean rewards when the "
+                                        "transitions are sparse (the mean rewards are stored in the transitions)");
+        }
+        reward_function = std::move(_reward_function);
+        transitions = std::move(_transitions);
         set_seed(_seed);
         id = "FiniteMDP";
         default_state = _default_state;
 
+        ns = transitions.ns;
+        na = transitions.na;
         check();
-        ns = reward_function.mean_rewards.size();
-        na = reward_function.mean_rewards[0].size();
+        build_alias_tables();
+        set_terminal_states(std::vector<int>());
 
         // observation and action spaces
         observation_space.set_n(ns);
@@ -34,19 +69,15 @@ namespace mdp
         reset();
     }
 
-    void FiniteMDP::set_params(DiscreteReward _reward_function, utils::vec::vec_3d _transitions, std::vector<int> _terminal_states, int _default_state /* = 0 */, int _seed /* = -1 */)
+    void FiniteMDP::set_params(DiscreteReward _reward_function, SparseTransitions _transitions, std::vector<int> _terminal_states, int _default_state /* = 0 */, int _seed /* = -1 */)
     {
-        set_params(_reward_function, _transitions, _default_state, _seed);
-        terminal_states = _terminal_states;
+        set_params(std::move(_reward_function), std::move(_transitions), _default_state, _seed);
+        set_terminal_states(_terminal_states);
     }
 
     void FiniteMDP::set_seed(int _seed)
     {
-        if (_seed < 1) 
-        {
-            _seed = std::rand();
-            // std::cout << _seed << std::endl;
-        }
+        if (_seed < 1) _seed = utils::rand::default_seed();
 
         randgen.set_seed(_seed);
         // seeds for spaces
@@ -56,32 +87,25 @@ namespace mdp
 
     void FiniteMDP::check()
     {
-        // Check shape of transitions and rewards
-        assert(reward_function.mean_rewards.size() > 0);
-        assert(reward_function.mean_rewards[0].size() > 0);
-        assert(reward_function.mean_rewards[0][0].size() > 0);
-        assert(transitions.size() > 0);
-        assert(transitions[0].size() > 0);
-        assert(transitions[0][0].size() > 0);
-
-        // Check consistency of number of states
-        assert(reward_function.mean_rewards[0][0].size() == reward_function.mean_rewards.size());
-        assert(transitions[0][0].size() == transitions.size());
-        assert(transitions.size() == reward_function.mean_rewards.size());
-
-        // Check consistency of number of actions
-        assert(reward_function.mean_rewards[0].size() == transitions[0].size());
+        // Check shape of transitions
+        assert(ns > 0);
+        assert(na > 0);
+        assert(transitions.complete() && "All rows of the transitions must be built");
+        assert(((int) transitions.probs().size()) == transitions.nnz());
+        assert(((int) transitions.rewards().size()) == transitions.nnz());
+        assert(default_state >= 0 && default_state < ns);
 
         // Check transition probabilities
-        for(int i = 0; i < transitions.size(); i++)
+        for(int i = 0; i < ns; i++)
         {
-            for(int a = 0; a < transitions[0].size(); a++)
+            for(int a = 0; a < na; a++)
             {
                 double sum = 0;
-                for(int j = 0; j < transitions[0][0].size(); j++)
+                for(int k = transitions.row_begin(i, a); k < transitions.row_end(i, a); k++)
                 {
-                    assert(transitions[i][a][j] >= 0.0);
-                    sum += transitions[i][a][j];
+                    assert(transitions.next_states()[k] >= 0 && transitions.next_states()[k] < ns);
+                    assert(transitions.probs()[k] >= 0.0);
+                    sum += transitions.probs()[k];
                 }
                 // std::cout << std::abs(sum - 1.0) << std::endl;
                 assert(std::abs(sum - 1.0) <= 1e-12 && "Probabilities must sum to 1");
@@ -89,28 +113,36 @@ namespace mdp
         }
     }
 
-    int FiniteMDP::reset()
+    void FiniteMDP::build_alias_tables()
     {
-        state = default_state;
-        return default_state;
+        alias_prob.resize(transitions.nnz());
+        alias_index.resize(transitions.nnz());
+        for(int s = 0; s < ns; s++)
+        {
+            for(int a = 0; a < na; a++)
+            {
+                int begin = transitions.row_begin(s, a);
+                int n = transitions.row_end(s, a) - begin;
+                utils::rand::build_alias_table(transitions.probs().data() + begin, n, alias_prob.data() + begin, alias_index.data() + begin);
+            }
+        }
+        alias_stamp = transitions.stamp();
     }
 
-    bool FiniteMDP::is_terminal(int _state)
+    int FiniteMDP::reset()
     {
-        return (std::find(terminal_states.begin(), terminal_states.end(), _state) != terminal_states.end());
+        state = default_state;
+        return default_state;
     }
 
-    /**
-     *  @note done is true if next_state is terminal.
-     */
-    StepResult<int> FiniteMDP::step(int action)
+    void FiniteMDP::set_terminal_states(std::vector<int> _terminal_states)
     {
-        // Sample next state
-        int next_state = randgen.choice(transitions[state][action]);
-        double reward = reward_function.sample(state, action, next_state, randgen); 
-        bool done = is_terminal(next_state);
-        StepResult<int> step_result(next_state, reward, done);
-        state = step_result.next_state;
-        return step_result;
+        terminal_states = _terminal_states;
+        terminal_mask.assign(ns, 0);
+        for(int s : terminal_states)
+        {
+            assert(s >= 0 && s < ns && "Invalid terminal state");
+            terminal_mask[s] = 1;
+        }
     }
 }
@@ -3,6 +3,7 @@
 #include <string>
 #include <cmath>
 #include <algorithm>
+#include <utility>
 #include <iostream>
 #include <iomanip>
 #include "gridworld.h"
@@ -28,9 +29,8 @@ namespace mdp
         std::vector<double> goal_coord = { (double) nrows - 1, (double) ncols - 1};
         std::vector<int> _terminal_states = {S - 1};
 
-        // Initialize vectors
-        utils::vec::vec_3d _rewards = utils::vec::get_zeros_3d(S, A, S);
-        utils::vec::vec_3d _transitions = utils::vec::get_zeros_3d(S, A, S);
+        // Initialize transitions: at most A next states per (state, action)
+        SparseTransitions _transitions(S, A, S*A*A);
 
         // Build maps between coordinates and indices
         int index = 0;
@@ -45,7 +45,8 @@ namespace mdp
             }
         }
 
-        // Build rewards
+        // Build rewards: the mean reward depends only on the next state
+        std::vector<double> next_state_reward(S);
         for(int jj = 0; jj < S; jj++)
         {
             std::vector<int>& next_state_coord = index2coord[jj];
@@ -60,15 +61,8 @@ namespace mdp
             {
                 reward = 1.0*(squared_distance == 0);
             }
-
-            for(int ii = 0; ii < S; ii++)
-            {
-                for(int aa = 0; aa < A; aa++)
-                {
-                    // reward depends on the distance between the next state and the goal state.
-                    _rewards[ii][aa][jj] = reward;
-                }
-            }
+            // reward depends on the distance between the next state and the goal state.
+            next_state_reward[jj] = reward;
         }
 
         // Build transitions
@@ -80,7 +74,7 @@ namespace mdp
                 // Coordinates of the next state
                 std::vector<int> next_state_coord = get_neighbor(state_coord, aa);
                 int next_state_index = coord2index[next_state_coord];
-                _transitions[ii][aa][next_state_index] = 1.0;
+                _transitions.add(next_state_index, 1.0, next_state_reward[next_state_index]);
 
                 /*
                     Handle the failure case.
@@ -94,21 +88,22 @@ namespace mdp
                         if (bb == aa) continue; 
                         std::vector<int> perturbed_next_state_coord = get_neighbor(state_coord, bb);
                         int perturbed_next_state_index = coord2index[perturbed_next_state_coord];
-                        _transitions[ii][aa][next_state_index] -= fail_p/4.0;
-                        _transitions[ii][aa][perturbed_next_state_index] += fail_p/4.0;
+                        _transitions.add(next_state_index, -fail_p/4.0, next_state_reward[next_state_index]);
+                        _transitions.add(perturbed_next_state_index, fail_p/4.0, next_state_reward[perturbed_next_state_index]);
                     }  
                 }             
+                _transitions.end_row();
             }
         }
         // Initialize base class (FiniteMDP)
         if (reward_sigma == 0)
-            set_params(_rewards, _transitions, _terminal_states);
+            set_params(DiscreteReward(), std::move(_transitions), _terminal_states);
         else
         {
             std::vector<double> noise_params;
             noise_params.push_back(reward_sigma);
-            DiscreteReward _reward_function(_rewards, "gaussian", noise_params);
-            set_params(_reward_function, _transitions, _terminal_states);
+            DiscreteReward _reward_function("gaussian", noise_params);
+            set_params(std::move(_reward_function), std::move(_transitions), _terminal_states);
         }
             
         id = "GridWorld";
@@ -151,7 +146,7 @@ namespace mdp
             std::string cell_str = "";
             
             // If state index (cell.first) is in terminal states
-            if (std::find(terminal_states.begin(), terminal_states.end(), cell.first) != terminal_states.end())
+            if (is_terminal(cell.first))
                 cell_str = " x  ";
             
             // If current state
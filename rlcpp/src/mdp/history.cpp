@@ -2,8 +2,8 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
-#include <fstream>
 #include "history.h"
+#include "historyfile.h"
 
 /*
     Following this answer: https://stackoverflow.com/a/13952386/5691288
@@ -51,25 +51,17 @@ namespace mdp
     template <>
     void History<int, int>::to_csv(std::string filename)
     {
-        std::ofstream file;
-        file.open (filename);
-        file << "episode,state,action,next_state, reward,";
-        for(int j = 0; j < n_extra_variables; j++) file << extra_variables[j].name << ",";
-        file << "\n";
-        for(int i = 0; i < length; i ++)
-        {
-            file << episodes[i] << ",";
-            file << states[i] << ",";
-            file << actions[i] << ",";
-            file << next_states[i] << ",";
-            file << rewards[i] << ",";
-            for(int j = 0; j < n_extra_variables; j++)
-            {
-                file <<  extra_variables[j].data[i] << ",";
-            }
-            file << "\n";
-        }
-        file.close();
+        write_history_csv(HistoryView::of(*this), filename);
+    }
+
+    /**
+     * @brief Write history in binary file
+     * @param filename example: "myfile.bin"
+     */
+    template <>
+    void History<int, int>::to_binary(std::string filename)
+    {
+        write_history_binary(HistoryView::of(*this), filename);
     }
 
 
@@ -0,0 +1,386 @@
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include "historyfile.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define RLCPP_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mdp
+{
+namespace
+{
+    const char magic[8] = {'R', 'L', 'C', 'P', 'P', 'H', 'S', 'T'};
+    const std::uint32_t version = 1;
+    const std::size_t alignment = 64;
+    const int n_base_columns = 5;
+    const char* base_names[n_base_columns] = {"episode", "state", "action", "next_state", "reward"};
+
+    enum column_type {int32_column = 0, float64_column = 1};
+
+    std::size_t align(std::size_t offset)
+    {
+        return (offset + alignment - 1)/alignment*alignment;
+    }
+
+    std::size_t type_size(std::uint32_t type)
+    {
+        return (type == int32_column) ? sizeof(std::int32_t) : sizeof(double);
+    }
+
+    /**
+     * Column of the file: type, name and data
+     */
+    struct Column
+    {
+        std::uint32_t type;
+        std::string name;
+        const void* values;
+    };
+
+    /**
+     * Buffered output to a csv file
+     */
+    class CsvWriter
+    {
+    public:
+        CsvWriter(const std::string& filename): file(std::fopen(filename.c_str(), "wb")), used(0), failed(false)
+        {
+            buffer.resize(1 << 20);
+        }
+
+        ~CsvWriter() { close(); }
+
+        bool is_open() const { return file != nullptr; }
+
+        bool close()
+        {
+            if (file == nullptr) return false;
+            flush();
+            failed = (std::fclose(file) != 0) || failed;
+            file = nullptr;
+            return !failed;
+        }
+
+        void write(const char* text)
+        {
+            for (const char* c = text; *c; c++) write(*c);
+        }
+
+        void write(char c)
+        {
+            reserve(1);
+            buffer[used++] = c;
+        }
+
+        void write(int value)
+        {
+            reserve(12);
+            char digits[12];
+            int n = 0;
+            // negative values are converted as unsigned, so that INT_MIN does not overflow
+            unsigned int u = (value < 0) ? 0u - (unsigned int) value : (unsigned int) value;
+            do
+            {
+                digits[n++] = '0' + u % 10;
+                u /= 10;
+            } while (u > 0);
+            if (value < 0) buffer[used++] = '-';
+            while (n > 0) buffer[used++] = digits[--n];
+        }
+
+        /**
+         * Same text as std::ostream << value with the default precision (printf format %g)
+         */
+        void write(double value)
+        {
+            // integers below 10^6 are printed without exponent nor decimals by %g
+            if (std::abs(value) < 1e6 && value == (int) value && !(value == 0 && std::signbit(value)))
+            {
+                write((int) value);
+                return;
+            }
+            reserve(32);
+            used += std::snprintf(buffer.data() + used, 32, "%g", value);
+        }
+
+    private:
+        void reserve(std::size_t n)
+        {
+            if (used + n > buffer.size()) flush();
+        }
+
+        void flush()
+        {
+            if (used > 0 && std::fwrite(buffer.data(), 1, used, file) != used) failed = true;
+            used = 0;
+        }
+
+        std::FILE* file;
+        std::vector<char> buffer;
+        std::size_t used;
+        bool failed;
+    };
+}
+
+HistoryView HistoryView::of(const History<int, int>& history)
+{
+    HistoryView view;
+    std::size_t n = history.rewards.size();
+    view.episodes = utils::Span<const int>(history.episodes.data(), n);
+    view.states = utils::Span<const int>(history.states.data(), n);
+    view.actions = utils::Span<const int>(history.actions.data(), n);
+    view.next_states = utils::Span<const int>(history.next_states.data(), n);
+    view.rewards = utils::Span<const double>(history.rewards.data(), n);
+    for (unsigned int j = 0; j < history.n_extra_variables; j++)
+    {
+        assert(history.extra_variables[j].data.size() == n && "Check length of extra variables!");
+        view.extra_names.push_back(history.extra_variables[j].name);
+        view.extra_variables.push_back(utils::Span<const double>(history.extra_variables[j].data.data(), n));
+    }
+    return view;
+}
+
+bool write_history_binary(const HistoryView& history, std::string filename)
+{
+    std::vector<Column> columns = {
+        {int32_column, base_names[0], history.episodes.data()},
+        {int32_column, base_names[1], history.states.data()},
+        {int32_column, base_names[2], history.actions.data()},
+        {int32_column, base_names[3], history.next_states.data()},
+        {float64_column, base_names[4], history.rewards.data()}};
+    for (std::size_t j = 0; j < history.extra_variables.size(); j++)
+    {
+        columns.push_back({float64_column, history.extra_names[j], history.extra_variables[j].data()});
+    }
+    std::uint32_t n_columns = columns.size();
+    std::uint64_t length = history.length();
+
+    // header and schema
+    std::vector<char> header(magic, magic + sizeof(magic));
+    auto append = [&header](const void* value, std::size_t n)
+    {
+        const char* bytes = (const char*) value;
+        header.insert(header.end(), bytes, bytes + n);
+    };
+    append(&version, sizeof(version));
+    append(&n_columns, sizeof(n_columns));
+    append(&length, sizeof(length));
+    std::size_t schema_size = 0;
+    for (const Column& column: columns) schema_size += 16 + column.name.size();
+    std::uint64_t offset = align(header.size() + schema_size);
+    std::vector<std::uint64_t> offsets;
+    for (const Column& column: columns)
+    {
+        std::uint32_t name_length = column.name.size();
+        append(&column.type, sizeof(column.type));
+        append(&name_length, sizeof(name_length));
+        append(&offset, sizeof(offset));
+        append(column.name.data(), name_length);
+        offsets.push_back(offset);
+        offset = align(offset + length*type_size(column.type));
+    }
+
+    std::FILE* file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr)
+    {
+        std::cerr << "History: cannot open " << filename << std::endl;
+        return false;
+    }
+    bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+    std::size_t position = header.size();
+    const char zeros[alignment] = {0};
+    for (std::size_t k = 0; k < columns.size() && ok; k++)
+    {
+        ok = std::fwrite(zeros, 1, offsets[k] - position, file) == offsets[k] - position;
+        std::size_t bytes = length*type_size(columns[k].type);
+        if (bytes > 0) ok = ok && std::fwrite(columns[k].values, 1, bytes, file) == bytes;
+        position = offsets[k] + bytes;
+    }
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) std::cerr << "History: error while writing " << filename << std::endl;
+    return ok;
+}
+
+bool write_history_csv(const HistoryView& history, std::string filename)
+{
+    CsvWriter file(filename);
+    if (!file.is_open())
+    {
+        std::cerr << "History: cannot open " << filename << std::endl;
+        return false;
+    }
+    std::size_t n_extra = history.extra_variables.size();
+    file.write("episode,state,action,next_state, reward,");
+    for (std::size_t j = 0; j < n_extra; j++)
+    {
+        file.write(history.extra_names[j].c_str());
+        file.write(',');
+    }
+    file.write('\n');
+    for (std::size_t i = 0; i < history.length(); i++)
+    {
+        file.write(history.episodes[i]);
+        file.write(',');
+        file.write(history.states[i]);
+        file.write(',');
+        file.write(history.actions[i]);
+        file.write(',');
+        file.write(history.next_states[i]);
+        file.write(',');
+        file.write(history.rewards[i]);
+        file.write(',');
+        for (std::size_t j = 0; j < n_extra; j++)
+        {
+            file.write(history.extra_variables[j][i]);
+            file.write(',');
+        }
+        file.write('\n');
+    }
+    bool ok = file.close();
+    if (!ok) std::cerr << "History: error while writing " << filename << std::endl;
+    return ok;
+}
+
+HistoryReader::HistoryReader(std::string filename)
+{
+#ifdef RLCPP_MMAP
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat status;
+    if (fd >= 0 && fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        void* mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            data = (const char*) mapping;
+            size = status.st_size;
+            mapped = true;
+        }
+    }
+    // the mapping remains valid after the file is closed
+    if (fd >= 0) ::close(fd);
+#else
+    std::ifstream file(filename, std::ios::binary);
+    if (file)
+    {
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (!buffer.empty())
+        {
+            data = buffer.data();
+            size = buffer.size();
+        }
+    }
+#endif
+    if (data == nullptr) std::cerr << "HistoryReader: cannot read " << filename << std::endl;
+    else if (!parse(filename)) close();
+}
+
+HistoryReader::~HistoryReader()
+{
+    close();
+}
+
+void HistoryReader::close()
+{
+#ifdef RLCPP_MMAP
+    if (mapped) munmap((void*) data, size);
+#endif
+    data = nullptr;
+    size = 0;
+    mapped = false;
+    buffer.clear();
+    columns = HistoryView();
+}
+
+bool HistoryReader::parse(const std::string& filename)
+{
+    std::size_t position = 0;
+    // copy n bytes of the header to value, if the file is large enough
+    auto read = [this, &position](void* value, std::size_t n)
+    {
+        if (position + n > size) return false;
+        std::memcpy(value, data + position, n);
+        position += n;
+        return true;
+    };
+    auto invalid = [&filename](const char* reason)
+    {
+        std::cerr << "HistoryReader: " << filename << " is not a valid history file (" << reason << ")" << std::endl;
+        return false;
+    };
+
+    char file_magic[sizeof(magic)];
+    std::uint32_t file_version, n_columns;
+    std::uint64_t length;
+    if (!read(file_magic, sizeof(file_magic)) || std::memcmp(file_magic, magic, sizeof(magic)) != 0)
+        return invalid("wrong magic string");
+    if (!read(&file_version, sizeof(file_version)) || file_version != version)
+        return invalid("unsupported version");
+    if (!read(&n_columns, sizeof(n_columns)) || !read(&length, sizeof(length)) || n_columns < n_base_columns)
+        return invalid("truncated header");
+
+    // each entry of the schema takes at least 16 bytes: check n_columns before allocating
+    if (n_columns > (size - position)/16) return invalid("truncated schema");
+    std::vector<Column> file_columns(n_columns);
+    for (std::uint32_t k = 0; k < n_columns; k++)
+    {
+        std::uint32_t name_length;
+        std::uint64_t offset;
+        if (!read(&file_columns[k].type, sizeof(std::uint32_t)) || !read(&name_length, sizeof(name_length))
+            || !read(&offset, sizeof(offset)) || position + name_length > size)
+            return invalid("truncated schema");
+        file_columns[k].name.assign(data + position, name_length);
+        position += name_length;
+
+        std::uint32_t expected_type = (k < 4) ? int32_column : float64_column;
+        if (file_columns[k].type != expected_type) return invalid("wrong column type");
+        if (k < n_base_columns && file_columns[k].name != base_names[k]) return invalid("wrong column name");
+        if (offset % alignment != 0 || offset > size || (size - offset)/type_size(expected_type) < length)
+            return invalid("truncated column");
+        file_columns[k].values = data + offset;
+    }
+
+    columns.episodes = utils::Span<const int>((const int*) file_columns[0].values, length);
+    columns.states = utils::Span<const int>((const int*) file_columns[1].values, length);
+    columns.actions = utils::Span<const int>((const int*) file_columns[2].values, length);
+    columns.next_states = utils::Span<const int>((const int*) file_columns[3].values, length);
+    columns.rewards = utils::Span<const double>((const double*) file_columns[4].values, length);
+    for (std::uint32_t k = n_base_columns; k < n_columns; k++)
+    {
+        columns.extra_names.push_back(file_columns[k].name);
+        columns.extra_variables.push_back(utils::Span<const double>((const double*) file_columns[k].values, length));
+    }
+    return true;
+}
+
+bool HistoryReader::to_csv(std::string filename) const
+{
+    return write_history_csv(columns, filename);
+}
+
+void HistoryReader::to_history(History<int, int>& history) const
+{
+    history.clear();
+    history.reserve_mem(length(), n_extra_variables());
+    history.states.assign(columns.states.begin(), columns.states.end());
+    history.actions.assign(columns.actions.begin(), columns.actions.end());
+    history.next_states.assign(columns.next_states.begin(), columns.next_states.end());
+    history.rewards.assign(columns.rewards.begin(), columns.rewards.end());
+    history.episodes.assign(columns.episodes.begin(), columns.episodes.end());
+    history.extra_variables.resize(n_extra_variables());
+    for (int j = 0; j < n_extra_variables(); j++)
+    {
+        history.extra_variables[j].name = columns.extra_names[j];
+        history.extra_variables[j].data.assign(columns.extra_variables[j].begin(), columns.extra_variables[j].end());
+    }
+    history.length = length();
+}
+}
@@ -9,7 +9,7 @@ namespace mdp
 {
 MountainCar::MountainCar()
 {
-    int _seed = std::rand();
+    int _seed = utils::rand::default_seed();
     randgen.set_seed(_seed);
     // observation and action spaces
     std::vector<double> _low = {-1.2, -0.07};
@@ -23,48 +23,22 @@ MountainCar::MountainCar()
     goal_position = 0.5;
     goal_velocity = 0;
 
-    state.push_back(0);
-    state.push_back(0);
+    na = 3;
+    state[position] = 0;
+    state[velocity] = 0;
 
     id = "MountainCar";
 }
 
-std::vector<double> MountainCar::reset()
+StaticState<2> MountainCar::reset()
 {
     state[position] = randgen.sample_real_uniform(observation_space.low[position], observation_space.high[position]);
     state[velocity] = 0;
     return state;
 }
 
-StepResult<std::vector<double>> MountainCar::step(int action)
-{
-    assert(action_space.contains(action));
-
-    std::vector<double>& lo = observation_space.low;
-    std::vector<double>& hi = observation_space.high;
-
-    double p = state[position];
-    double v = state[velocity];
-
-    v += (action-1)*force + std::cos(3*p)*(-gravity);
-    v = utils::clamp(v, lo[velocity], hi[velocity]);
-    p += v;
-    p = utils::clamp(p, lo[position], hi[position]);
-    if ((abs(p-lo[position])<1e-10) && (v<0)) v = 0;
-
-    bool done = is_terminal(state);
-    double reward = 0.0;
-    if (done) reward = 1.0;
-
-    state[position] = p;
-    state[velocity] = v;
-
-    StepResult<std::vector<double>> step_result(state, reward, done);
-    return step_result;
-}
-
-bool MountainCar::is_terminal(std::vector<double> state)
+bool MountainCar::is_terminal(const StaticState<2>& _state) const
 {
-    return ((state[position] >= goal_position) && (state[velocity]>=goal_velocity));
+    return ((_state[position] >= goal_position) && (_state[velocity]>=goal_velocity));
 }
 }
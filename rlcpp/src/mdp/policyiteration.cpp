@@ -0,0 +1,230 @@
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include "policyiteration.h"
+#include "bellman.h"
+
+namespace mdp
+{
+namespace
+{
+    double dot(const std::vector<double>& x, const std::vector<double>& y)
+    {
+        double sum = 0;
+        for (std::size_t i = 0; i < x.size(); i++) sum += x[i]*y[i];
+        return sum;
+    }
+
+    double sup_norm(const std::vector<double>& x)
+    {
+        double norm = 0;
+        for (double value: x) norm = std::max(norm, std::abs(value));
+        return norm;
+    }
+}
+
+PolicyIteration::PolicyIteration(FiniteMDP& mdp, double gamma, double tolerance /* = 1e-8 */,
+                                 int max_iterations /* = 1000 */) :
+    mdp(mdp), greedy_span(0), gamma(gamma), tolerance(tolerance), max_iterations(max_iterations),
+    solver(gauss_seidel_solver), omega(1.5), max_solver_iterations(100000), evaluation_sweeps(0),
+    iterations(0), solver_iterations(0), converged(false)
+{
+    assert(gamma >= 0 && gamma < 1 && "PolicyIteration requires gamma in [0, 1)");
+}
+
+void PolicyIteration::run()
+{
+    if ((int) policy.size() != mdp.ns) policy.assign(mdp.ns, 0);
+    if ((int) V.size() != mdp.ns) V.assign(mdp.ns, 0.0);
+
+    converged = false;
+    solver_iterations = 0;
+    for (iterations = 0; iterations < max_iterations; )
+    {
+        if (evaluation_sweeps > 0)
+        {
+            set_policy(policy);
+            apply_policy_operator(V, evaluation_sweeps);
+            solver_iterations += evaluation_sweeps;
+        }
+        else
+        {
+            solver_iterations += evaluate_policy(policy, V);
+        }
+
+        int n_changes = improve_policy();
+        iterations++;
+        bool stop = (evaluation_sweeps > 0) ? (greedy_span < tolerance*(1 - gamma)/std::max(gamma, 1e-300))
+                                            : (n_changes == 0);
+        if (stop)
+        {
+            converged = true;
+            break;
+        }
+    }
+}
+
+int PolicyIteration::evaluate_policy(const std::vector<int>& pi, std::vector<double>& Vpi)
+{
+    set_policy(pi);
+    switch (solver)
+    {
+        case sor_solver:
+            return evaluate_sor(Vpi, omega);
+        case bicgstab_solver:
+            return evaluate_bicgstab(Vpi);
+        default:
+            return evaluate_sor(Vpi, 1.0);
+    }
+}
+
+void PolicyIteration::set_policy(const std::vector<int>& pi)
+{
+    const SparseTransitions& P = mdp.transitions;
+    row_begin.resize(mdp.ns);
+    row_end.resize(mdp.ns);
+    r_pi.resize(mdp.ns);
+    diagonal.resize(mdp.ns);
+    for (int s = 0; s < mdp.ns; s++)
+    {
+        row_begin[s] = P.row_begin(s, pi[s]);
+        row_end[s] = P.row_end(s, pi[s]);
+        r_pi[s] = 0;
+        diagonal[s] = 0;
+        for (int k = row_begin[s]; k < row_end[s]; k++)
+        {
+            r_pi[s] += P.probs()[k]*P.rewards()[k];
+            if (P.next_states()[k] == s) diagonal[s] = P.probs()[k];
+        }
+    }
+}
+
+int PolicyIteration::evaluate_sor(std::vector<double>& Vpi, double _omega)
+{
+    const SparseTransitions& P = mdp.transitions;
+    // |Vpi - V*| <= gamma/(1-gamma) * |change| for Gauss-Seidel sweeps
+    double threshold = tolerance*(1 - gamma)/std::max(gamma, 1e-300);
+
+    int iteration = 0;
+    while (iteration < max_solver_iterations)
+    {
+        iteration++;
+        double change = 0;
+        for (int s = 0; s < mdp.ns; s++)
+        {
+            int k = row_begin[s];
+            // x = r_pi(s) + gamma sum_s' P_pi(s, s') Vpi(s'), and state s solves its own equation:
+            // Vpi(s) = Vpi(s) + (x - Vpi(s))/(1 - gamma P_pi(s, s))
+            double x = bellman::expected_value(P.probs().data() + k, P.rewards().data() + k, P.next_states().data() + k,
+                                               Vpi.data(), row_end[s] - k, gamma);
+            double delta = _omega*(x - Vpi[s])/(1 - gamma*diagonal[s]);
+            Vpi[s] += delta;
+            change = std::max(change, std::abs(delta));
+        }
+        if (change < threshold) break;
+    }
+    return iteration;
+}
+
+int PolicyIteration::evaluate_bicgstab(std::vector<double>& Vpi)
+{
+    int n = mdp.ns;
+    // |Vpi - V*| <= |residual|/(1-gamma)
+    double threshold = tolerance*(1 - gamma);
+
+    std::vector<double> r(n), r0(n), p(n, 0.0), v(n, 0.0), s(n), t(n);
+    multiply(Vpi, r);
+    for (int i = 0; i < n; i++) r[i] = r_pi[i] - r[i];
+    r0 = r;
+    double rho = 1, alpha = 1, w = 1;
+
+    int iteration = 0;
+    while (sup_norm(r) >= threshold && iteration < max_solver_iterations)
+    {
+        iteration++;
+        double rho_new = dot(r0, r);
+        if (rho_new == 0)
+        {
+            // breakdown: restart with the current residual
+            r0 = r;
+            std::fill(p.begin(), p.end(), 0.0);
+            std::fill(v.begin(), v.end(), 0.0);
+            rho = alpha = w = 1;
+            rho_new = dot(r0, r);
+        }
+        double beta = (rho_new/rho)*(alpha/w);
+        for (int i = 0; i < n; i++) p[i] = r[i] + beta*(p[i] - w*v[i]);
+        multiply(p, v);
+        alpha = rho_new/dot(r0, v);
+        for (int i = 0; i < n; i++)
+        {
+            Vpi[i] += alpha*p[i];
+            s[i] = r[i] - alpha*v[i];
+        }
+        if (sup_norm(s) < threshold)
+        {
+            r = s;
+            break;
+        }
+        multiply(s, t);
+        w = dot(t, s)/dot(t, t);
+        for (int i = 0; i < n; i++)
+        {
+            Vpi[i] += w*s[i];
+            r[i] = s[i] - w*t[i];
+        }
+        rho = rho_new;
+    }
+    return iteration;
+}
+
+void PolicyIteration::apply_policy_operator(std::vector<double>& Vpi, int k)
+{
+    const SparseTransitions& P = mdp.transitions;
+    std::vector<double> Vnext(mdp.ns);
+    for (int i = 0; i < k; i++)
+    {
+        for (int s = 0; s < mdp.ns; s++)
+        {
+            int b = row_begin[s];
+            Vnext[s] = bellman::expected_value(P.probs().data() + b, P.rewards().data() + b, P.next_states().data() + b,
+                                               Vpi.data(), row_end[s] - b, gamma);
+        }
+        Vpi.swap(Vnext);
+    }
+}
+
+void PolicyIteration::multiply(const std::vector<double>& x, std::vector<double>& y) const
+{
+    const SparseTransitions& P = mdp.transitions;
+    for (int s = 0; s < mdp.ns; s++)
+    {
+        double sum = 0;
+        for (int k = row_begin[s]; k < row_end[s]; k++) sum += P.probs()[k]*x[P.next_states()[k]];
+        y[s] = x[s] - gamma*sum;
+    }
+}
+
+int PolicyIteration::improve_policy()
+{
+    std::vector<double> q(mdp.na);
+    int n_changes = 0;
+    double diff_min = 0;
+    double diff_max = 0;
+    for (int s = 0; s < mdp.ns; s++)
+    {
+        bellman::backup_state(mdp.transitions, s, V.data(), q.data(), gamma);
+        int best = std::max_element(q.begin(), q.end()) - q.begin();
+        if (q[best] > q[policy[s]] + tolerance)
+        {
+            policy[s] = best;
+            n_changes++;
+        }
+        double diff = q[best] - V[s];
+        if ((s == 0) || (diff < diff_min)) diff_min = diff;
+        if ((s == 0) || (diff > diff_max)) diff_max = diff;
+    }
+    greedy_span = diff_max - diff_min;
+    return n_changes;
+}
+}
@@ -0,0 +1,179 @@
+#include <assert.h>
+#include <algorithm>
+#include <numeric>
+#include <atomic>
+#include "sparse_transitions.h"
+
+namespace mdp
+{
+    namespace
+    {
+        /**
+         * Source of unique stamps, shared by all SparseTransitions objects.
+         */
+        std::atomic<unsigned long> stamp_counter(0);
+    }
+
+    SparseTransitions::SparseTransitions(): ns(0), na(0)
+    {
+        row_offsets.push_back(0);
+        touch();
+    }
+
+    SparseTransitions::SparseTransitions(int _ns, int _na, int nnz_hint /* = 0 */): ns(_ns), na(_na)
+    {
+        touch();
+        assert(ns > 0 && na > 0);
+        row_offsets.reserve(ns*na + 1);
+        row_offsets.push_back(0);
+        if (nnz_hint > 0)
+        {
+            entry_next_states.reserve(nnz_hint);
+            entry_probs.reserve(nnz_hint);
+            entry_rewards.reserve(nnz_hint);
+        }
+    }
+
+    SparseTransitions::SparseTransitions(const utils::vec::tensor_3d& P, const utils::vec::tensor_3d& R):
+        SparseTransitions(P.dim1(), P.dim2())
+    {
+        assert(P.dim3() == ns && "Transitions must have dimensions (S, A, S)");
+        assert(R.dim1() == ns && R.dim2() == na && R.dim3() == ns && "Rewards and transitions must have the same shape");
+        for(int s = 0; s < ns; s++)
+        {
+            for(int a = 0; a < na; a++)
+            {
+                const double* p = P.row(s, a).data();
+                const double* r = R.row(s, a).data();
+                for(int sn = 0; sn < ns; sn++)
+                {
+                    if (p[sn] != 0.0) add(sn, p[sn], r[sn]);
+                }
+                end_row();
+            }
+        }
+    }
+
+    void SparseTransitions::touch()
+    {
+        current_stamp = ++stamp_counter;
+    }
+
+    void SparseTransitions::set_next_state(int k, int next_state)
+    {
+        assert(k >= 0 && k < nnz() && next_state >= 0 && next_state < ns);
+        entry_next_states[k] = next_state;
+        touch();
+    }
+
+    void SparseTransitions::set_prob(int k, double prob)
+    {
+        assert(k >= 0 && k < nnz() && prob >= 0.0);
+        entry_probs[k] = prob;
+        touch();
+    }
+
+    void SparseTransitions::set_reward(int k, double reward)
+    {
+        assert(k >= 0 && k < nnz());
+        entry_rewards[k] = reward;
+        touch();
+    }
+
+    int SparseTransitions::find_in_current_row(int next_state) const
+    {
+        for(int k = row_offsets.back(); k < nnz(); k++)
+        {
+            if (entry_next_states[k] == next_state) return k;
+        }
+        return -1;
+    }
+
+    void SparseTransitions::add(int next_state, double prob, double reward)
+    {
+        assert(!complete() && "All rows have already been built");
+        assert(next_state >= 0 && next_state < ns);
+        touch();
+        int k = find_in_current_row(next_state);
+        if (k < 0)
+        {
+            entry_next_states.push_back(next_state);
+            entry_probs.push_back(prob);
+            entry_rewards.push_back(reward);
+        }
+        else
+        {
+            double total = entry_probs[k] + prob;
+            if (reward != entry_rewards[k] && total != 0.0)
+            {
+                entry_rewards[k] = (entry_probs[k]*entry_rewards[k] + prob*reward)/total;
+            }
+            entry_probs[k] = total;
+        }
+    }
+
+    void SparseTransitions::end_row()
+    {
+        assert(!complete() && "All rows have already been built");
+        touch();
+        int begin = row_offsets.back();
+        int end = nnz();
+
+        // sort entries of the row by next state (rows are small)
+        std::vector<int> order(end - begin);
+        std::iota(order.begin(), order.end(), begin);
+        std::sort(order.begin(), order.end(),
+                  [this](int i, int j) { return entry_next_states[i] < entry_next_states[j]; });
+
+        std::vector<int> row_states;
+        std::vector<double> row_probs, row_rewards;
+        for(int k : order)
+        {
+            if (entry_probs[k] == 0.0) continue;
+            row_states.push_back(entry_next_states[k]);
+            row_probs.push_back(entry_probs[k]);
+            row_rewards.push_back(entry_rewards[k]);
+        }
+
+        entry_next_states.resize(begin);
+        entry_probs.resize(begin);
+        entry_rewards.resize(begin);
+        entry_next_states.insert(entry_next_states.end(), row_states.begin(), row_states.end());
+        entry_probs.insert(entry_probs.end(), row_probs.begin(), row_probs.end());
+        entry_rewards.insert(entry_rewards.end(), row_rewards.begin(), row_rewards.end());
+        row_offsets.push_back(nnz());
+    }
+
+    bool SparseTransitions::complete() const
+    {
+        return ((int) row_offsets.size()) == ns*na + 1;
+    }
+
+    double SparseTransitions::prob(int state, int action, int next_state) const
+    {
+        for(int k = row_begin(state, action); k < row_end(state, action); k++)
+        {
+            if (entry_next_states[k] == next_state) return entry_probs[k];
+        }
+        return 0.0;
+    }
+
+    double SparseTransitions::reward(int state, int action, int next_state) const
+    {
+        for(int k = row_begin(state, action); k < row_end(state, action); k++)
+        {
+            if (entry_next_states[k] == next_state) return entry_rewards[k];
+        }
+        return 0.0;
+    }
+
+    std::vector<double> SparseTransitions::dense_row(int state, int action) const
+    {
+        std::vector<double> row(ns, 0.0);
+        for(int k = row_begin(state, action); k < row_end(state, action); k++)
+        {
+            row[entry_next_states[k]] = entry_probs[k];
+        }
+        return row;
+    }
+}
@@ -0,0 +1,88 @@
+#include <assert.h>
+#include <algorithm>
+#include "valueiteration.h"
+#include "bellman.h"
+
+namespace mdp
+{
+ValueIteration::ValueIteration(FiniteMDP& mdp, double gamma, double epsilon /* = 1e-6 */,
+                               int max_iterations /* = 100000 */) :
+    mdp(mdp), diff_min(0), diff_max(0), gamma(gamma), epsilon(epsilon), max_iterations(max_iterations),
+    sweep_order(gauss_seidel), store_q(false), iterations(0), residual(0), converged(false)
+{
+    assert(gamma >= 0 && gamma < 1 && "ValueIteration requires gamma in [0, 1)");
+}
+
+void ValueIteration::run()
+{
+    if ((int) V.size() != mdp.ns) V.assign(mdp.ns, 0.0);
+    q.resize(mdp.na);
+    if (sweep_order == jacobi) V_old.resize(mdp.ns);
+    else V_old = std::vector<double>();
+
+    // Jacobi sweeps: span of the change < epsilon*(1-gamma)/gamma (Puterman, 1994, Thm 6.6.6)
+    // Gauss-Seidel sweeps: sup norm of the change < epsilon*(1-gamma)/(2*gamma) (Puterman, 1994, Thm 6.3.3)
+    double threshold = epsilon*(1 - gamma)/std::max(gamma, 1e-300);
+    if (sweep_order == gauss_seidel) threshold /= 2;
+    converged = false;
+    for (iterations = 0; iterations < max_iterations; )
+    {
+        sweep();
+        iterations++;
+        residual = (sweep_order == jacobi) ? diff_max - diff_min : std::max(diff_max, -diff_min);
+        if (residual < threshold)
+        {
+            converged = true;
+            break;
+        }
+    }
+    // After a Jacobi sweep, V* lies between V + gamma/(1-gamma)*diff_min and V + gamma/(1-gamma)*diff_max:
+    // move V to the midpoint
+    if (sweep_order == jacobi && iterations > 0)
+    {
+        double shift = gamma/(1 - gamma)*(diff_min + diff_max)/2;
+        for (int s = 0; s < mdp.ns; s++) V[s] += shift;
+    }
+    compute_greedy_policy();
+}
+
+void ValueIteration::sweep()
+{
+    // Jacobi sweeps read the values of the previous sweep, Gauss-Seidel sweeps read V itself
+    const double* v = V.data();
+    if (sweep_order == jacobi)
+    {
+        V_old.swap(V);
+        v = V_old.data();
+    }
+
+    diff_min = 0;
+    diff_max = 0;
+    for (int s = 0; s < mdp.ns; s++)
+    {
+        double old_value = v[s];
+        bellman::backup_state(mdp.transitions, s, v, q.data(), gamma);
+        double new_value = *std::max_element(q.begin(), q.end());
+        V[s] = new_value;
+
+        double diff = new_value - old_value;
+        if ((s == 0) || (diff < diff_min)) diff_min = diff;
+        if ((s == 0) || (diff > diff_max)) diff_max = diff;
+    }
+}
+
+void ValueIteration::compute_greedy_policy()
+{
+    q.resize(mdp.na);
+    greedy_policy.assign(mdp.ns, 0);
+    if (store_q) Q = utils::vec::get_zeros_2d(mdp.ns, mdp.na);
+    else Q = utils::vec::vec_2d();
+
+    for (int s = 0; s < mdp.ns; s++)
+    {
+        double* qs = store_q ? Q[s].data() : q.data();
+        bellman::backup_state(mdp.transitions, s, V.data(), qs, gamma);
+        greedy_policy[s] = std::max_element(qs, qs + mdp.na) - qs;
+    }
+}
+}
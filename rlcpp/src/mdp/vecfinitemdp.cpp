@@ -0,0 +1,99 @@
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include "vecfinitemdp.h"
+
+namespace mdp
+{
+VecFiniteMDP::VecFiniteMDP(const FiniteMDP& mdp, int n_envs, unsigned seed /* = 42 */, int horizon /* = 0 */) :
+    ns(mdp.ns), na(mdp.na), default_state(mdp.default_state), horizon(horizon), id(mdp.id)
+{
+    assert(n_envs > 0 && "VecFiniteMDP requires at least one slot");
+    std::shared_ptr<Model> _model = std::make_shared<Model>();
+    const SparseTransitions& P = mdp.transitions;
+    _model->row_ptr.resize(ns*na + 1);
+    for (int s = 0; s < ns; s++)
+        for (int a = 0; a < na; a++) _model->row_ptr[s*na + a] = P.row_begin(s, a);
+    _model->row_ptr[ns*na] = P.nnz();
+    _model->next_states = P.next_states();
+    _model->rewards = P.rewards();
+    _model->alias_prob.resize(P.nnz());
+    _model->alias_index.resize(P.nnz());
+    for (int row = 0; row < ns*na; row++)
+    {
+        int begin = _model->row_ptr[row];
+        utils::rand::build_alias_table(P.probs().data() + begin, _model->row_ptr[row + 1] - begin,
+                                       _model->alias_prob.data() + begin, _model->alias_index.data() + begin);
+    }
+    _model->terminal_mask = mdp.terminal_mask;
+    _model->noise_sigma = (mdp.reward_function.noise == DiscreteReward::gaussian) ?
+                          mdp.reward_function.noise_params[0] : 0;
+    model = _model;
+
+    states.resize(n_envs);
+    episode_steps.resize(n_envs);
+    generators.resize(n_envs);
+    set_seed(seed);
+    reset();
+}
+
+void VecFiniteMDP::reset()
+{
+    for (int i = 0; i < size(); i++) reset(i);
+}
+
+void VecFiniteMDP::reset(int i)
+{
+    states[i] = default_state;
+    episode_steps[i] = 0;
+}
+
+void VecFiniteMDP::set_seed(unsigned seed)
+{
+    for (int i = 0; i < size(); i++) generators[i].set_stream(seed, i);
+}
+
+void VecFiniteMDP::step(const int* actions, StepBatch& out)
+{
+    int n = size();
+    if (out.size() != n) out.resize(n);
+    const Model& m = *model;
+    const int* row_ptr = m.row_ptr.data();
+    const double* alias_prob = m.alias_prob.data();
+    const int* alias_index = m.alias_index.data();
+    const unsigned char* terminal_mask = m.terminal_mask.data();
+    int* next_states = out.next_states.data();
+    double* rewards = out.rewards.data();
+    unsigned char* dones = out.dones.data();
+
+    for (int i = 0; i < n; i++)
+    {
+        int row = states[i]*na + actions[i];
+        int begin = row_ptr[row];
+        int length = row_ptr[row + 1] - begin;
+
+        // alias sampling, see utils::rand::Random::sample_alias()
+        double x = length*utils::rand::uniform(generators[i]);
+        int j = std::min((int) x, length - 1);
+        int k = begin + ((x - j < alias_prob[begin + j]) ? j : alias_index[begin + j]);
+
+        int next_state = m.next_states[k];
+        double reward = m.rewards[k];
+        if (m.noise_sigma > 0)
+        {
+            // Box-Muller transform
+            double u1 = 1.0 - utils::rand::uniform(generators[i]);
+            double u2 = utils::rand::uniform(generators[i]);
+            reward += m.noise_sigma*std::sqrt(-2.0*std::log(u1))*std::cos(6.283185307179586*u2);
+        }
+        int steps = episode_steps[i] + 1;
+        bool done = terminal_mask[next_state] || (horizon > 0 && steps >= horizon);
+
+        next_states[i] = next_state;
+        rewards[i] = reward;
+        dones[i] = done;
+        states[i] = done ? default_state : next_state;
+        episode_steps[i] = done ? 0 : steps;
+    }
+}
+}
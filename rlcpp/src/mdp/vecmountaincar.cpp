@@ -0,0 +1,229 @@
+#include <assert.h>
+#include <cmath>
+#include "vecmountaincar.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define RLCPP_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+/*
+    The dynamics are computed by a scalar kernel and, on x86 processors, by an AVX2 kernel compiled with a
+    function-specific target attribute. Both kernels perform the same operations in the same order (without fused
+    multiply-add), so that they give the same results.
+*/
+
+namespace mdp
+{
+constexpr double VecMountainCar::min_position;
+constexpr double VecMountainCar::max_position;
+constexpr double VecMountainCar::max_speed;
+constexpr double VecMountainCar::goal_position;
+constexpr double VecMountainCar::goal_velocity;
+constexpr double VecMountainCar::force;
+constexpr double VecMountainCar::gravity;
+
+namespace
+{
+    constexpr double half_pi = 1.5707963267948966;
+    // pi = pi_hi + pi_lo, with pi_hi the double closest to pi
+    constexpr double pi_hi = 3.141592653589793;
+    constexpr double pi_lo = 1.2246467991473532e-16;
+
+    /**
+     * Coefficients (-1)^k/(2k)! of the Taylor series of the cosine, k = 0, ..., 10
+     */
+    constexpr int n_coefficients = 11;
+    constexpr double cos_coefficients[n_coefficients] = {
+        1.0, -1.0/2, 1.0/24, -1.0/720, 1.0/40320, -1.0/3628800, 1.0/479001600, -1.0/87178291200.0,
+        1.0/20922789888000.0, -1.0/6402373705728000.0, 1.0/2432902008176640000.0};
+
+    typedef void (*step_kernel)(const int*, double*, double*, double*, double*, double*, unsigned char*, int);
+
+    // -------------------------------------------------------------------------------------------------
+    // Scalar kernel
+    // -------------------------------------------------------------------------------------------------
+
+    double cosine_scalar(double x)
+    {
+        double y = std::abs(x);
+        bool flip = y > half_pi;
+        // cos(y) = -cos(y - pi), with y - pi_hi computed exactly for y in [pi/2, 2*pi]
+        double r = flip ? (y - pi_hi) - pi_lo : y;
+        double z = r*r;
+        double c = cos_coefficients[n_coefficients - 1];
+        for(int k = n_coefficients - 2; k >= 0; k--) c = c*z + cos_coefficients[k];
+        return flip ? -c : c;
+    }
+
+    /**
+     * Move the cars i = 0, ..., n-1: update p and v in place, and store the new state, the reward and the done
+     * flag in out_p, out_v, rewards and dones.
+     */
+    void step_scalar(const int* actions, double* p, double* v, double* out_p, double* out_v, double* rewards,
+                     unsigned char* dones, int n)
+    {
+        const double lo_p = VecMountainCar::min_position, hi_p = VecMountainCar::max_position;
+        const double max_v = VecMountainCar::max_speed;
+        for(int i = 0; i < n; i++)
+        {
+            double vi = v[i] + ((actions[i] - 1)*VecMountainCar::force
+                                + cosine_scalar(3*p[i])*(-VecMountainCar::gravity));
+            vi = (vi < -max_v) ? -max_v : (max_v < vi) ? max_v : vi;
+            double pi = p[i] + vi;
+            pi = (pi < lo_p) ? lo_p : (hi_p < pi) ? hi_p : pi;
+            if ((std::abs(pi - lo_p) < 1e-10) && (vi < 0)) vi = 0;
+            bool done = (pi >= VecMountainCar::goal_position) && (vi >= VecMountainCar::goal_velocity);
+
+            p[i] = out_p[i] = pi;
+            v[i] = out_v[i] = vi;
+            rewards[i] = done ? 1.0 : 0.0;
+            dones[i] = done;
+        }
+    }
+
+#ifdef RLCPP_X86_SIMD
+    // -------------------------------------------------------------------------------------------------
+    // AVX2 kernel
+    // -------------------------------------------------------------------------------------------------
+
+    __attribute__((target("avx2")))
+    __m256d cosine_avx2(__m256d x)
+    {
+        const __m256d sign_mask = _mm256_set1_pd(-0.0);
+        __m256d y = _mm256_andnot_pd(sign_mask, x);
+        __m256d flip = _mm256_cmp_pd(y, _mm256_set1_pd(half_pi), _CMP_GT_OQ);
+        __m256d reduced = _mm256_sub_pd(_mm256_sub_pd(y, _mm256_set1_pd(pi_hi)), _mm256_set1_pd(pi_lo));
+        __m256d r = _mm256_blendv_pd(y, reduced, flip);
+        __m256d z = _mm256_mul_pd(r, r);
+        __m256d c = _mm256_set1_pd(cos_coefficients[n_coefficients - 1]);
+        for(int k = n_coefficients - 2; k >= 0; k--)
+        {
+            c = _mm256_add_pd(_mm256_mul_pd(c, z), _mm256_set1_pd(cos_coefficients[k]));
+        }
+        return _mm256_xor_pd(c, _mm256_and_pd(flip, sign_mask));
+    }
+
+    __attribute__((target("avx2")))
+    void step_avx2(const int* actions, double* p, double* v, double* out_p, double* out_v, double* rewards,
+                   unsigned char* dones, int n)
+    {
+        const __m256d sign_mask = _mm256_set1_pd(-0.0);
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m256d force = _mm256_set1_pd(VecMountainCar::force);
+        const __m256d minus_gravity = _mm256_set1_pd(-VecMountainCar::gravity);
+        const __m256d three = _mm256_set1_pd(3.0);
+        const __m256d lo_p = _mm256_set1_pd(VecMountainCar::min_position);
+        const __m256d hi_p = _mm256_set1_pd(VecMountainCar::max_position);
+        const __m256d lo_v = _mm256_set1_pd(-VecMountainCar::max_speed);
+        const __m256d hi_v = _mm256_set1_pd(VecMountainCar::max_speed);
+        const __m256d epsilon = _mm256_set1_pd(1e-10);
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d goal_p = _mm256_set1_pd(VecMountainCar::goal_position);
+        const __m256d goal_v = _mm256_set1_pd(VecMountainCar::goal_velocity);
+
+        int i = 0;
+        for(; i + 4 <= n; i += 4)
+        {
+            __m256d pi = _mm256_loadu_pd(p + i);
+            __m256d vi = _mm256_loadu_pd(v + i);
+            __m256d a = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*) (actions + i)));
+            __m256d acceleration = _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(a, one), force),
+                                                 _mm256_mul_pd(cosine_avx2(_mm256_mul_pd(three, pi)), minus_gravity));
+            vi = _mm256_add_pd(vi, acceleration);
+            // (x < lo) ? lo : (hi < x) ? hi : x
+            vi = _mm256_blendv_pd(_mm256_blendv_pd(vi, hi_v, _mm256_cmp_pd(hi_v, vi, _CMP_LT_OQ)), lo_v,
+                                  _mm256_cmp_pd(vi, lo_v, _CMP_LT_OQ));
+            pi = _mm256_add_pd(pi, vi);
+            pi = _mm256_blendv_pd(_mm256_blendv_pd(pi, hi_p, _mm256_cmp_pd(hi_p, pi, _CMP_LT_OQ)), lo_p,
+                                  _mm256_cmp_pd(pi, lo_p, _CMP_LT_OQ));
+            __m256d at_wall = _mm256_and_pd(
+                _mm256_cmp_pd(_mm256_andnot_pd(sign_mask, _mm256_sub_pd(pi, lo_p)), epsilon, _CMP_LT_OQ),
+                _mm256_cmp_pd(vi, zero, _CMP_LT_OQ));
+            vi = _mm256_blendv_pd(vi, zero, at_wall);
+            __m256d done = _mm256_and_pd(_mm256_cmp_pd(pi, goal_p, _CMP_GE_OQ), _mm256_cmp_pd(vi, goal_v, _CMP_GE_OQ));
+
+            _mm256_storeu_pd(p + i, pi);
+            _mm256_storeu_pd(out_p + i, pi);
+            _mm256_storeu_pd(v + i, vi);
+            _mm256_storeu_pd(out_v + i, vi);
+            _mm256_storeu_pd(rewards + i, _mm256_and_pd(done, one));
+            int mask = _mm256_movemask_pd(done);
+            for(int j = 0; j < 4; j++) dones[i + j] = (mask >> j) & 1;
+        }
+        step_scalar(actions + i, p + i, v + i, out_p + i, out_v + i, rewards + i, dones + i, n - i);
+    }
+#endif
+
+    step_kernel best_kernel()
+    {
+#ifdef RLCPP_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return step_avx2;
+#endif
+        return step_scalar;
+    }
+
+    step_kernel simd_kernel()
+    {
+        static step_kernel selected = best_kernel();
+        return selected;
+    }
+}
+
+VecMountainCar::VecMountainCar(int n_envs, unsigned seed /* = 42 */, int horizon /* = 0 */) :
+    horizon(horizon), use_simd(true), na(3), id("MountainCar")
+{
+    assert(n_envs > 0 && "VecMountainCar requires at least one car");
+    positions.resize(n_envs);
+    velocities.resize(n_envs);
+    episode_steps.resize(n_envs);
+    generators.resize(n_envs);
+    set_seed(seed);
+    reset();
+}
+
+void VecMountainCar::reset()
+{
+    for (int i = 0; i < size(); i++) reset(i);
+}
+
+void VecMountainCar::reset(int i)
+{
+    positions[i] = min_position + (max_position - min_position)*utils::rand::uniform(generators[i]);
+    velocities[i] = 0;
+    episode_steps[i] = 0;
+}
+
+void VecMountainCar::set_seed(unsigned seed)
+{
+    for (int i = 0; i < size(); i++) generators[i].set_stream(seed, i);
+}
+
+double VecMountainCar::cosine(double x)
+{
+    return cosine_scalar(x);
+}
+
+std::string VecMountainCar::instruction_set() const
+{
+    return (use_simd && simd_kernel() != step_scalar) ? "avx2" : "scalar";
+}
+
+void VecMountainCar::step(const int* actions, MountainCarStepBatch& out)
+{
+    int n = size();
+    if (out.size() != n) out.resize(n);
+    step_kernel kernel = use_simd ? simd_kernel() : step_scalar;
+    kernel(actions, positions.data(), velocities.data(), out.positions.data(), out.velocities.data(),
+           out.rewards.data(), out.dones.data(), n);
+
+    // episode lengths and resets
+    for (int i = 0; i < n; i++)
+    {
+        episode_steps[i] += 1;
+        if (horizon > 0 && episode_steps[i] >= horizon) out.dones[i] = 1;
+        if (out.dones[i]) reset(i);
+    }
+}
+}
@@ -0,0 +1,80 @@
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include "experimentrunner.h"
+
+namespace online
+{
+    ExperimentRunner::ExperimentRunner(TrialFactory factory, int n_configs, int n_seeds, int n_episodes,
+                                       int n_threads /* = 0 */) :
+        factory(factory), n_configs(n_configs), n_seeds(n_seeds), n_episodes(n_episodes), n_threads(n_threads),
+        first_seed(1)
+    {
+        assert(n_configs > 0 && n_seeds > 0 && n_episodes > 0 && "ExperimentRunner requires at least one trial");
+    }
+
+    void ExperimentRunner::run()
+    {
+        regret.assign(n_configs, utils::vec::get_zeros_2d(n_seeds, n_episodes));
+        {
+            utils::parallel::TaskPool pool(n_threads);
+            for (int config = 0; config < n_configs; config++)
+            {
+                for (int i = 0; i < n_seeds; i++)
+                {
+                    // each task only writes its own row of regret
+                    pool.submit([this, config, i]()
+                    {
+                        Trial trial = factory(config, first_seed + i);
+                        std::vector<double>& trial_regret = regret[config][i];
+                        double total = 0;
+                        for (int k = 0; k < n_episodes; k++)
+                        {
+                            int initial_state = trial.run_episode ? trial.run_episode() : trial.algorithm->run_episode();
+                            total += trial.episode_regret(initial_state);
+                            trial_regret[k] = total;
+                        }
+                        if (trial.finish) trial.finish();
+                    });
+                }
+            }
+            pool.wait();
+        }
+
+        mean_regret = utils::vec::get_zeros_2d(n_configs, n_episodes);
+        std_regret = utils::vec::get_zeros_2d(n_configs, n_episodes);
+        for (int config = 0; config < n_configs; config++)
+        {
+            for (int k = 0; k < n_episodes; k++)
+            {
+                double sum = 0, sum_squares = 0;
+                for (int i = 0; i < n_seeds; i++)
+                {
+                    double value = regret[config][i][k];
+                    sum += value;
+                    sum_squares += value*value;
+                }
+                double mean = sum/n_seeds;
+                mean_regret[config][k] = mean;
+                std_regret[config][k] = std::sqrt(std::max(0.0, sum_squares/n_seeds - mean*mean));
+            }
+        }
+    }
+
+    void ExperimentRunner::to_csv(int config, std::string filename) const
+    {
+        std::ofstream file;
+        file.open(filename);
+        for (int k = 0; k <= n_episodes; k++)
+        {
+            for (int i = 0; i < n_seeds; i++)
+            {
+                file << ((k == 0) ? 0.0 : regret[config][i][k - 1]);
+                if (i < n_seeds - 1) file << ",";
+            }
+            file << "\n";
+        }
+        file.close();
+    }
+}
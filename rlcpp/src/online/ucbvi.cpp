@@ -1,15 +1,20 @@
 #include <cmath>
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <algorithm>
 #include "ucbvi.h"
+#include "bellman.h"
+#include "random.h"
 
 
 namespace online
 {
     UCBVI::UCBVI(mdp::FiniteMDP &mdp, int horizon,
-                double scale_factor, std::string b_type, bool save_history) :
+                double scale_factor, std::string b_type, bool save_history, unsigned seed) :
         mdp(mdp), horizon(horizon), VI(mdp::EpisodicVI(mdp, horizon)),
-        scale_factor(scale_factor), b_type(b_type), save_history(save_history)
+        scale_factor(scale_factor), b_type(b_type), incremental_planning(false), planning_backups(0),
+        rarely_switching(false), seed(seed), save_history(save_history)
     {
         reset();
     }
@@ -18,13 +23,19 @@ namespace online
     {
         delta = 0.1;
         t = episode = 0;
-        Phat = utils::vec::get_zeros_3d(mdp.ns, mdp.na, mdp.ns);
-        Rhat = utils::vec::get_zeros_3d(mdp.ns, mdp.na, mdp.ns);
         N_sa = utils::vec::get_zeros_i2d(mdp.ns, mdp.na);
-        N_sas = utils::vec::get_zeros_i3d(mdp.ns, mdp.na, mdp.ns);
-        bonus = utils::vec::get_zeros_3d(horizon, mdp.ns, mdp.na);
+        successors.assign(mdp.ns*mdp.na, std::vector<int>());
+        successor_counts.assign(mdp.ns*mdp.na, std::vector<int>());
+        inv_N_sa = utils::vec::get_zeros_2d(mdp.ns, mdp.na);
+        R_sum = utils::vec::get_zeros_2d(mdp.ns, mdp.na);
+        hoeffding_factor = utils::vec::get_zeros_2d(mdp.ns, mdp.na);
+        bernstein_variance_factor = utils::vec::get_zeros_2d(mdp.ns, mdp.na);
+        bernstein_offset = utils::vec::get_zeros_2d(mdp.ns, mdp.na);
+        for (int s=0; s < mdp.ns; s++)
+            for (int a=0; a < mdp.na; a++)
+                update_bonus_factors(s, a);
 
-        Q = utils::vec::get_zeros_3d(horizon + 1, mdp.ns, mdp.na);
+        Q = utils::vec::tensor_3d(horizon + 1, mdp.ns, mdp.na);
         policy = utils::vec::get_zeros_i2d(horizon, mdp.ns);
         V = utils::vec::get_zeros_2d(horizon + 1, mdp.ns);
         Vpi = utils::vec::get_zeros_2d(horizon + 1, mdp.ns);
@@ -32,6 +43,14 @@ namespace online
         all_episode_rewards.clear();
         episode_value.clear();
 
+        updated_pairs.clear();
+        pair_updated.assign(mdp.ns*mdp.na, 0);
+        predecessors.assign(mdp.ns, std::vector<int>());
+        planned = false;
+        N_sa_at_plan = utils::vec::get_zeros_i2d(mdp.ns, mdp.na);
+        replan_needed = true;
+        n_replans = 0;
+
         /* Initialize MDP history
          - horizon*1000 is a rough estimate of the number of total timesteps (=horizon*number_of_episodes)
         - _n_extra_variables is the number of extra variables to be stored
@@ -52,95 +71,169 @@ namespace online
 
     void UCBVI::get_optimistic_q()
     {
-        //initialize stage H+1
-        for (int i=0; i < mdp.ns; ++i)
-        {
-            V[horizon-1][i] = 0;
-            for (int j=0; j <mdp.na; ++j)
-                Q[horizon][i][j] = 0;
-        }
-        double tmp;
-
+        planning_backups = 0;
         if (episode > 0)
         {
-            if (b_type == "hoeffding")
+            use_hoeffding = (b_type == "hoeffding");
+            use_bernstein = (b_type == "bernstein");
+            if (incremental_planning && planned && b_type == planned_b_type && scale_factor == planned_scale_factor)
             {
-                compute_hoeffding_bonus();
+                incremental_planning_sweep();
             }
-
-            for(int h=horizon-1; h>=0; h--)
+            else
             {
-                if (b_type == "bernstein")
-                {
-                    compute_bernstein_bonus(h, V[std::min(h+1, horizon-1)]);
-                }
-                for (int s=0; s < mdp.ns; s++)
-                {
-                    for (int a=0; a < mdp.na; a++)
-                    {
-                        tmp = 0;
-                        for (int sn=0; sn < mdp.ns; sn++)
-                        {
-                            tmp +=  Phat[s][a][sn] * (Rhat[s][a][sn] + V[h+1][sn]);
-                        }
-                        // add noise to break ties
-                        double noise = 1e-10 * std::rand()/(RAND_MAX + 1u);
-                        // std::cout << noise <<std::endl;
-                        tmp += bonus[h][s][a] + noise;
-                        Q[h][s][a] = tmp;
-
-                        if ((a == 0) || (tmp > V[h][s]))
-                        {
-                            V[h][s] = tmp;
-                            policy[h][s] = a;
-                        }
-
-                    }
-                    // truncate value function
-                    V[h][s] = std::min((double)(horizon - h + 2), V[h][s]);
-                }
+                full_planning();
             }
+            planned = true;
+            planned_b_type = b_type;
+            planned_scale_factor = scale_factor;
         }
+
+        for (int pair: updated_pairs) pair_updated[pair] = 0;
+        updated_pairs.clear();
     }
 
-    void UCBVI::compute_hoeffding_bonus()
+    void UCBVI::full_planning()
     {
-        for (int h=0; h < horizon; ++h)
+        for(int h=horizon-1; h>=0; h--)
         {
             for (int s=0; s < mdp.ns; s++)
             {
                 for (int a=0; a < mdp.na; a++)
                 {
-                    double L = std::log(5 * mdp.ns * mdp.na * std::max(1, N_sa[s][a]) / delta);
-                    bonus[h][s][a] = scale_factor * 7 * horizon * L / sqrt(std::max(1, N_sa[s][a]));
+                    backup(h, s, a);
                 }
+                update_value(h, s);
             }
         }
+        planning_backups = ((long) horizon)*mdp.ns*mdp.na;
     }
 
-    void UCBVI::compute_bernstein_bonus(int h,  std::vector<double> Vhp1)
+    void UCBVI::incremental_planning_sweep()
     {
+        // pairs to recompute at the current stage, and states whose value changed at the previous stage (h+1)
+        std::vector<int> pairs;
+        std::vector<char> pair_queued(mdp.ns*mdp.na, 0);
+        std::vector<int> states;
+        std::vector<char> state_queued(mdp.ns, 0);
+        std::vector<int> changed_states;
 
-        for (int s=0; s < mdp.ns; s++)
+        for(int h=horizon-1; h>=0; h--)
         {
-            for (int a=0; a < mdp.na; a++)
+            pairs = updated_pairs;
+            for (int pair: pairs) pair_queued[pair] = 1;
+            for (int sn: changed_states)
             {
-                double L = std::log(5 * mdp.ns * mdp.na * std::max(1, N_sa[s][a]) / delta);
-                double n = std::max(1, N_sa[s][a]);
-                double var = 0, mean = 0;
-                for (int sn=0; sn < mdp.ns; ++sn)
+                for (int pair: predecessors[sn])
                 {
-                    mean += Phat[s][a][sn] * Vhp1[sn];
+                    if (!pair_queued[pair])
+                    {
+                        pair_queued[pair] = 1;
+                        pairs.push_back(pair);
+                    }
                 }
-                for (int sn=0; sn < mdp.ns; ++sn)
+            }
+
+            for (int pair: pairs)
+            {
+                int s = pair / mdp.na;
+                backup(h, s, pair % mdp.na);
+                pair_queued[pair] = 0;
+                if (!state_queued[s])
                 {
-                    var += Phat[s][a][sn] * (Vhp1[sn] - mean) * (Vhp1[sn] - mean);
+                    state_queued[s] = 1;
+                    states.push_back(s);
                 }
-                double T1 = sqrt(8 * L * var / n) + 14 * L * horizon / (3*n);
-                double T2 = sqrt(8 * horizon * horizon / n);
-                bonus[h][s][a] = scale_factor * (T1 + T2);
             }
+            planning_backups += pairs.size();
+
+            changed_states.clear();
+            for (int s: states)
+            {
+                double old_value = V[h][s];
+                update_value(h, s);
+                if (V[h][s] != old_value) changed_states.push_back(s);
+                state_queued[s] = 0;
+            }
+            states.clear();
+        }
+    }
+
+    void UCBVI::backup(int h, int s, int a)
+    {
+        const double* v = V[h+1].data();
+        double tmp;
+        if (use_bernstein)
+        {
+            double variance;
+            double mean = next_value_moments(s, a, v, &variance);
+            tmp = R_sum[s][a] * inv_N_sa[s][a] + mean + bernstein_bonus(s, a, variance);
+        }
+        else
+        {
+            tmp = empirical_backup(s, a, v);
+            if (use_hoeffding) tmp += hoeffding_bonus(s, a);
         }
+        // add noise to break ties
+        Q(h, s, a) = tmp + tie_break_noise(h, s, a);
+    }
+
+    double UCBVI::tie_break_noise(int h, int s, int a) const
+    {
+        std::uint64_t index = ((std::uint64_t) h*mdp.ns + s)*mdp.na + a;
+        return 1e-10 * utils::rand::hashed_uniform(seed, index);
+    }
+
+    double UCBVI::empirical_backup(int s, int a, const double* v) const
+    {
+        if (N_sa[s][a] == 0) return 0;
+        int pair = s*mdp.na + a;
+        double sum = mdp::bellman::weighted_sum(successor_counts[pair].data(), successors[pair].data(), v,
+                                                successors[pair].size());
+        return (R_sum[s][a] + sum) * inv_N_sa[s][a];
+    }
+
+    void UCBVI::update_value(int h, int s)
+    {
+        for (int a=0; a < mdp.na; a++)
+        {
+            double tmp = Q(h, s, a);
+            if ((a == 0) || (tmp > V[h][s]))
+            {
+                V[h][s] = tmp;
+                policy[h][s] = a;
+            }
+        }
+        // truncate value function
+        V[h][s] = std::min((double)(horizon - h + 2), V[h][s]);
+    }
+
+    void UCBVI::update_bonus_factors(int s, int a)
+    {
+        double n = std::max(1, N_sa[s][a]);
+        double L = std::log(5.0 * mdp.ns * mdp.na * n / delta);
+        hoeffding_factor[s][a] = 7 * horizon * L / sqrt(n);
+        bernstein_variance_factor[s][a] = 8 * L / n;
+        bernstein_offset[s][a] = 14 * L * horizon / (3*n) + sqrt(8 * horizon * horizon / n);
+    }
+
+    double UCBVI::next_value_moments(int s, int a, const double* v, double* variance) const
+    {
+        int pair = s*mdp.na + a;
+        const std::vector<int>& next_states = successors[pair];
+        if (next_states.empty())
+        {
+            *variance = 0;
+            return 0;
+        }
+        // shifting by the value of a next state avoids the cancellation in E[(V-shift)^2] - E[V-shift]^2
+        double shift = v[next_states[0]];
+        double sum, sum_squares;
+        mdp::bellman::weighted_moments(successor_counts[pair].data(), next_states.data(), v, next_states.size(),
+                                       shift, &sum, &sum_squares);
+        double mean = sum * inv_N_sa[s][a];
+        *variance = std::max(0.0, sum_squares * inv_N_sa[s][a] - mean * mean);
+        return shift + mean;
     }
 
     int UCBVI::run_episode()
@@ -155,10 +248,17 @@ namespace online
         int action;
         int state = mdp.reset();
         int initial_state = state;
-        get_optimistic_q();
+        if (!rarely_switching || replan_needed)
+        {
+            get_optimistic_q();
 
-        // True value of the greedy policy wrt Q
-        VI.evaluate_policy(policy, Vpi);
+            // True value of the greedy policy wrt Q
+            VI.evaluate_policy(policy, Vpi);
+
+            N_sa_at_plan = N_sa;
+            replan_needed = false;
+            n_replans += 1;
+        }
         episode_value.push_back(Vpi[0][state]);
 
         std::vector<double> extra_vars = {trueV[0][state] - Vpi[0][state]};
@@ -193,17 +293,40 @@ namespace online
         return initial_state;
     }
 
+    int UCBVI::n_sas(int state, int action, int next_state) const
+    {
+        int pair = state*mdp.na + action;
+        const std::vector<int>& next_states = successors[pair];
+        for (std::size_t k=0; k < next_states.size(); ++k)
+        {
+            if (next_states[k] == next_state) return successor_counts[pair][k];
+        }
+        return 0;
+    }
+
     void UCBVI::update(int state, int action, double reward, int next_state)
     {
-        int old_n = N_sas[state][action][next_state];
-        N_sas[state][action][next_state] += 1;
+        int pair = state*mdp.na + action;
+        std::vector<int>& next_states = successors[pair];
+        std::size_t k = std::find(next_states.begin(), next_states.end(), next_state) - next_states.begin();
+        if (k == next_states.size())
+        {
+            next_states.push_back(next_state);
+            successor_counts[pair].push_back(0);
+            predecessors[next_state].push_back(pair);
+        }
+        successor_counts[pair][k] += 1;
+        if (!pair_updated[pair])
+        {
+            pair_updated[pair] = 1;
+            updated_pairs.push_back(pair);
+        }
         N_sa[state][action] += 1;
-        // int n_sa = 0;
-        // for (int sn=0; sn < mdp.ns; ++sn) n_sa += N_sas[state][action][sn];
-        for (int sn=0; sn < mdp.ns; ++sn)
-            Phat[state][action][sn] = ((double) N_sas[state][action][sn]) / N_sa[state][action];
-
-        Rhat[state][action][next_state] = (Rhat[state][action][next_state] * old_n + reward) / (old_n + 1.);
+        if (N_sa[state][action] >= 2*N_sa_at_plan[state][action]) replan_needed = true;
+        // the estimates phat() and rhat() are normalized lazily, with inv_N_sa
+        inv_N_sa[state][action] = 1.0 / N_sa[state][action];
+        update_bonus_factors(state, action);
+        R_sum[state][action] += reward;
     }
 
 
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include "parallel.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace utils
+{
+    namespace parallel
+    {
+        ThreadPool::ThreadPool(int _n_threads): next(0)
+        {
+            if (_n_threads < 1) _n_threads = std::thread::hardware_concurrency();
+            n_threads = std::max(1, _n_threads);
+            for(int id = 1; id < n_threads; id++)
+            {
+                workers.push_back(std::thread(&ThreadPool::worker_loop, this, id));
+            }
+        }
+
+        ThreadPool::~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            start_cv.notify_all();
+            for(std::thread& worker: workers) worker.join();
+        }
+
+        void ThreadPool::parallel_for(int _begin, int _end, const std::function<void(int, int)>& _body,
+                                      schedule_type _schedule /* = static_schedule */, int _chunk_size /* = 0 */)
+        {
+            if (_end <= _begin) return;
+            if (n_threads == 1)
+            {
+                _body(_begin, _end);
+                return;
+            }
+
+            std::lock_guard<std::mutex> call_lock(call_mutex);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                body = &_body;
+                begin = _begin;
+                end = _end;
+                schedule = _schedule;
+                chunk_size = (_chunk_size > 0) ? _chunk_size : std::max(1, (_end - _begin)/(8*n_threads));
+                next = _begin;
+                n_running = n_threads - 1;
+                generation++;
+            }
+            start_cv.notify_all();
+
+            run_share(0);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            done_cv.wait(lock, [this] { return n_running == 0; });
+            body = nullptr;
+        }
+
+        void ThreadPool::worker_loop(int id)
+        {
+            unsigned long seen_generation = 0;
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    start_cv.wait(lock, [&] { return stopping || generation != seen_generation; });
+                    if (stopping) return;
+                    seen_generation = generation;
+                }
+
+                run_share(id);
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    n_running--;
+                }
+                done_cv.notify_one();
+            }
+        }
+
+        void ThreadPool::run_share(int id)
+        {
+            if (schedule == static_schedule)
+            {
+                long length = end - begin;
+                int lo = begin + (int) ((length*id)/n_threads);
+                int hi = begin + (int) ((length*(id + 1))/n_threads);
+                if (lo < hi) (*body)(lo, hi);
+            }
+            else
+            {
+                while (true)
+                {
+                    int lo = next.fetch_add(chunk_size);
+                    if (lo >= end) break;
+                    (*body)(lo, std::min(end, lo + chunk_size));
+                }
+            }
+        }
+
+        namespace
+        {
+            /**
+             * Pool and index of the thread running the current task, used to submit tasks to its own queue.
+             */
+            thread_local TaskPool* current_pool = nullptr;
+            thread_local int current_id = -1;
+        }
+
+        TaskPool::TaskPool(int _n_threads /* = 0 */)
+        {
+            if (_n_threads < 1) _n_threads = std::thread::hardware_concurrency();
+            n_threads = std::max(1, _n_threads);
+            for(int id = 0; id < n_threads; id++) queues.push_back(std::unique_ptr<TaskQueue>(new TaskQueue()));
+            for(int id = 0; id < n_threads; id++)
+            {
+                workers.push_back(std::thread(&TaskPool::worker_loop, this, id));
+            }
+        }
+
+        TaskPool::~TaskPool()
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                done_cv.wait(lock, [this] { return n_unfinished == 0; });
+                stopping = true;
+            }
+            work_cv.notify_all();
+            for(std::thread& worker: workers) worker.join();
+        }
+
+        void TaskPool::submit(std::function<void()> task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            int id = (current_pool == this) ? current_id : (int) (next_queue++ % n_threads);
+            {
+                std::lock_guard<std::mutex> queue_lock(queues[id]->mutex);
+                queues[id]->tasks.push_back(std::move(task));
+            }
+            n_queued++;
+            n_unfinished++;
+            work_cv.notify_one();
+        }
+
+        void TaskPool::wait()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done_cv.wait(lock, [this] { return n_unfinished == 0; });
+            if (error)
+            {
+                std::exception_ptr first_error = error;
+                error = nullptr;
+                std::rethrow_exception(first_error);
+            }
+        }
+
+        bool TaskPool::pop_task(int id, std::function<void()>& task)
+        {
+            {
+                TaskQueue& own = *queues[id];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (!own.tasks.empty())
+                {
+                    task = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    return true;
+                }
+            }
+            for(int k = 1; k < n_threads; k++)
+            {
+                TaskQueue& other = *queues[(id + k) % n_threads];
+                std::lock_guard<std::mutex> lock(other.mutex);
+                if (!other.tasks.empty())
+                {
+                    task = std::move(other.tasks.front());
+                    other.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void TaskPool::worker_loop(int id)
+        {
+            current_pool = this;
+            current_id = id;
+            std::function<void()> task;
+            while (true)
+            {
+                if (pop_task(id, task))
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        n_queued--;
+                    }
+                    std::exception_ptr task_error;
+                    try
+                    {
+                        task();
+                    }
+                    catch (...)
+                    {
+                        task_error = std::current_exception();
+                    }
+                    task = nullptr;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (task_error && !error) error = task_error;
+                    if (--n_unfinished == 0) done_cv.notify_all();
+                }
+                else
+                {
+                    // sleep until a task is submitted
+                    std::unique_lock<std::mutex> lock(mutex);
+                    work_cv.wait(lock, [this] { return stopping || n_queued > 0; });
+                    if (stopping && n_queued == 0) return;
+                }
+            }
+        }
+
+        bool pin_current_thread(int index)
+        {
+#ifdef __linux__
+            // processors allowed for the process
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) return false;
+            std::vector<int> cpus;
+            for(int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            {
+                if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+            }
+            if (cpus.empty() || index < 0) return false;
+
+            cpu_set_t selected;
+            CPU_ZERO(&selected);
+            CPU_SET(cpus[index % cpus.size()], &selected);
+            return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &selected) == 0;
+#else
+            (void) index;
+            return false;
+#endif
+        }
+    }
+}
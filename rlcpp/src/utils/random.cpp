@@ -1,48 +1,124 @@
 #include "random.h"
 #include <assert.h> 
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 
 namespace utils
 {
     namespace rand
     {
-        Random::Random(unsigned _seed /* = 42 */)
+        void Philox4x32::set_stream(std::uint32_t seed, std::uint32_t stream, std::uint64_t substream /* = 0 */)
         {
-            seed = _seed;
-            generator.seed(_seed);
+            key[0] = seed;
+            key[1] = stream;
+            counter[0] = counter[1] = 0;
+            counter[2] = (std::uint32_t) substream;
+            counter[3] = (std::uint32_t) (substream >> 32);
+            block(counter, key, buffer);
+            index = 0;
+        }
+
+        void Philox4x32::discard(unsigned long long n)
+        {
+            // position of the next output, counted from the beginning of the substream
+            std::uint64_t position = ((((std::uint64_t) counter[1] << 32) | counter[0]) << 2) + index + n;
+            std::uint64_t block_index = position >> 2;
+            counter[0] = (std::uint32_t) block_index;
+            counter[1] = (std::uint32_t) (block_index >> 32);
+            block(counter, key, buffer);
+            index = position & 3;
         }
 
-        void Random::set_seed(unsigned _seed)
+        namespace
+        {
+            /**
+             * @brief Seed generator with the sequence (seed, stream, substream).
+             */
+            void seed_stream(std::mt19937& generator, unsigned seed, std::uint32_t stream, std::uint64_t substream)
+            {
+                if (stream == 0 && substream == 0)
+                {
+                    generator.seed(seed);
+                    return;
+                }
+                std::seed_seq sequence = {seed, stream, (std::uint32_t) substream, (std::uint32_t) (substream >> 32)};
+                generator.seed(sequence);
+            }
+
+            void seed_stream(Philox4x32& generator, unsigned seed, std::uint32_t stream, std::uint64_t substream)
+            {
+                generator.set_stream(seed, stream, substream);
+            }
+
+            /**
+             * State and number of outputs of the generator of default_seed()
+             */
+            std::atomic<std::uint64_t> default_seed_state(0);
+            std::atomic<std::uint64_t> default_seed_count(0);
+        }
+
+        template <typename Engine>
+        BasicRandom<Engine>::BasicRandom(unsigned _seed /* = 42 */)
+        {
+            set_seed(_seed);
+        }
+
+        template <typename Engine>
+        void BasicRandom<Engine>::set_seed(unsigned _seed)
         {
             seed = _seed;
             generator.seed(_seed);
+            gaussian_dist.reset();
         }
 
-        int Random::choice(std::vector<double>& prob, double u /* = -1 */)
+        template <typename Engine>
+        void BasicRandom<Engine>::set_stream(std::uint32_t _stream, std::uint64_t _substream /* = 0 */)
+        {
+            seed_stream(generator, seed, _stream, _substream);
+            gaussian_dist.reset();
+        }
+
+        template <typename Engine>
+        BasicRandom<Engine> BasicRandom<Engine>::split(std::uint32_t _stream, std::uint64_t _substream /* = 0 */) const
+        {
+            BasicRandom other(*this);
+            other.set_stream(_stream, _substream);
+            return other;
+        }
+
+        template <typename Engine>
+        void BasicRandom<Engine>::discard(unsigned long long n)
+        {
+            generator.discard(n);
+        }
+
+        template <typename Engine>
+        int BasicRandom<Engine>::choice(std::vector<double>& prob, double u /* = -1 */)
+        {
+            return choice(prob.data(), prob.size(), u);
+        }
+
+        template <typename Engine>
+        int BasicRandom<Engine>::choice(const double* prob, int n, double u /* = -1 */)
         {
-            int n = prob.size();
             if (n == 0)
             {
                 std::cerr << "Calling Random::choice with empty probability vector! Returning -1." << std::endl;
                 return -1;
             }
-            std::vector<double> cumul(n);
 
-            // Compute cumulative distribution function 
-            cumul[0] = prob[0];
-            for(int i = 1; i < n; i++)
-            {
-                cumul[i] = cumul[i-1] + prob[i];
-            }
             // Get sample 
             double unif_sample;
             if (u == -1){ unif_sample = real_unif_dist(generator); }
             else {unif_sample = u;}
 
-            int sample = 0;
+            // Scan the cumulative distribution function 
+            double cumul = 0;
             for(int i = 0; i < n; i++)
             {
-                if (unif_sample <= cumul[i])
+                cumul += prob[i];
+                if (unif_sample <= cumul)
                 {
                     return i;
                 }
@@ -50,18 +126,143 @@ namespace utils
             return -1;  // in case of error
         }
 
-        double Random::sample_real_uniform(double a, double b)
+        template <typename Engine>
+        int BasicRandom<Engine>::sample_alias(const double* alias_prob, const int* alias_index, int n)
+        {
+            double x = n*real_unif_dist(generator);
+            int i = std::min((int) x, n - 1);
+            return (x - i < alias_prob[i]) ? i : alias_index[i];
+        }
+
+        template <typename Engine>
+        double BasicRandom<Engine>::sample_real_uniform(double a, double b)
         {
             assert( b >= a && "b must be greater than a");
             double unif_sample = real_unif_dist(generator);
             return (b - a)*unif_sample + a;
         }
 
-        double Random::sample_gaussian(double mu, double sigma)
+        template <typename Engine>
+        double BasicRandom<Engine>::sample_gaussian(double mu, double sigma)
         {
             assert ( sigma > 0  && "Standard deviation must be positive.");
             double standard_sample = gaussian_dist(generator);
             return mu + sigma*standard_sample;
         }
+
+        template <typename Engine>
+        void BasicRandom<Engine>::add_gaussian(double* values, int n, double sigma)
+        {
+            assert ( sigma > 0  && "Standard deviation must be positive.");
+            for(int i = 0; i < n; i++)
+            {
+                values[i] += sigma*gaussian_dist(generator);
+            }
+        }
+
+        template class BasicRandom<std::mt19937>;
+        template class BasicRandom<Philox4x32>;
+
+        int default_seed()
+        {
+            std::uint64_t k = default_seed_count++;
+            return 1 + (int) (splitmix64(default_seed_state, k) % ((1u << 30) - 1));
+        }
+
+        void set_default_seed(std::uint64_t seed)
+        {
+            default_seed_state = seed;
+            default_seed_count = 0;
+        }
+
+        constexpr int CategoricalSampler::linear_search_max;
+
+        CategoricalSampler::CategoricalSampler(const std::vector<double>& prob)
+        {
+            set_prob(prob.data(), prob.size());
+        }
+
+        CategoricalSampler::CategoricalSampler(const double* prob, int n)
+        {
+            set_prob(prob, n);
+        }
+
+        void CategoricalSampler::set_prob(const double* prob, int _n)
+        {
+            n = _n;
+            cdf.resize(n);
+            double cumul = 0;
+            for(int i = 0; i < n; i++)
+            {
+                cumul += prob[i];
+                cdf[i] = cumul;
+            }
+        }
+
+        int CategoricalSampler::sample(double u) const
+        {
+            if (n == 0)
+            {
+                std::cerr << "Calling CategoricalSampler::sample with empty probability vector! Returning -1." << std::endl;
+                return -1;
+            }
+            const double* first = cdf.data();
+            if (n <= linear_search_max)
+            {
+                for(int i = 0; i < n; i++)
+                {
+                    if (u <= first[i]) return i;
+                }
+                return -1;
+            }
+            // Branch-free lower bound: the result is in [base, base + len]
+            const double* base = first;
+            int len = n;
+            while (len > 1)
+            {
+                int half = len/2;
+                base = (base[half - 1] < u) ? base + half : base;
+                len -= half;
+            }
+            int index = (base - first) + (*base < u);
+            return (index < n) ? index : -1;
+        }
+
+        void build_alias_table(const double* prob, int n, double* alias_prob, int* alias_index)
+        {
+            assert(n > 0 && "Cannot build alias table of empty distribution");
+            double sum = 0;
+            for(int i = 0; i < n; i++) sum += prob[i];
+            assert(sum > 0 && "Probabilities must have positive sum");
+
+            // Scaled probabilities, split into entries below (small) and above (large) the average
+            std::vector<double> scaled(n);
+            std::vector<int> small, large;
+            for(int i = 0; i < n; i++)
+            {
+                scaled[i] = prob[i]*n/sum;
+                if (scaled[i] < 1.0) small.push_back(i);
+                else large.push_back(i);
+            }
+
+            // Each small entry is completed by mass from a large entry
+            while (!small.empty() && !large.empty())
+            {
+                int i = small.back(); small.pop_back();
+                int j = large.back();
+                alias_prob[i] = scaled[i];
+                alias_index[i] = j;
+                scaled[j] = (scaled[j] + scaled[i]) - 1.0;
+                if (scaled[j] < 1.0)
+                {
+                    large.pop_back();
+                    small.push_back(j);
+                }
+            }
+
+            // Remaining entries have (up to rounding errors) probability 1
+            for(int i : large) { alias_prob[i] = 1.0; alias_index[i] = i; }
+            for(int i : small) { alias_prob[i] = 1.0; alias_index[i] = i; }
+        }
     }
 }
\ No newline at end of file
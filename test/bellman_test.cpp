@@ -0,0 +1,72 @@
+#include <vector>
+#include <cmath>
+#include "catch.hpp"
+#include "mdp.h"
+
+TEST_CASE( "Testing sparse Bellman kernels", "[bellman_sparse]" )
+{
+    mdp::GridWorld mdp(12, 15, 0.2, 0.5);
+    const mdp::SparseTransitions& P = mdp.transitions;
+    utils::rand::Random randgen(17);
+    std::vector<double> v(mdp.ns);
+    for (int s = 0; s < mdp.ns; s++) v[s] = randgen.sample_real_uniform(-1, 1);
+
+    std::vector<double> q(mdp.na);
+    for (int s = 0; s < mdp.ns; s++)
+    {
+        mdp::bellman::backup_state(P, s, v.data(), q.data());
+        for (int a = 0; a < mdp.na; a++)
+        {
+            // reference: scalar loop, same summation order
+            double expected = 0;
+            for (int k = P.row_begin(s, a); k < P.row_end(s, a); k++)
+                expected += P.probs()[k]*(P.rewards()[k] + v[P.next_states()[k]]);
+            REQUIRE( q[a] == expected );
+
+            int k = P.row_begin(s, a);
+            double value = mdp::bellman::expected_value(P.probs().data() + k, P.rewards().data() + k,
+                                                        P.next_states().data() + k, v.data(), P.row_end(s, a) - k);
+            REQUIRE( value == expected );
+
+            double discounted = 0;
+            for (int k = P.row_begin(s, a); k < P.row_end(s, a); k++)
+                discounted += P.probs()[k]*(P.rewards()[k] + 0.9*v[P.next_states()[k]]);
+            value = mdp::bellman::expected_value(P.probs().data() + k, P.rewards().data() + k,
+                                                 P.next_states().data() + k, v.data(), P.row_end(s, a) - k, 0.9);
+            REQUIRE( value == discounted );
+        }
+    }
+}
+
+TEST_CASE( "Testing count-weighted Bellman kernels", "[bellman_counts]" )
+{
+    int ns = 37;
+    utils::rand::Random randgen(42);
+    std::vector<double> v(ns);
+    for (int s = 0; s < ns; s++) v[s] = randgen.sample_real_uniform(0, 10);
+
+    // every remainder length of the vectorized loops
+    for (int n = 0; n <= 20; n++)
+    {
+        std::vector<int> counts(n);
+        std::vector<int> indices(n);
+        double weighted = 0;
+        for (int k = 0; k < n; k++)
+        {
+            counts[k] = (7*k + 3) % 5;
+            indices[k] = (11*k) % ns;
+            weighted += counts[k]*v[indices[k]];
+        }
+        REQUIRE( std::abs(mdp::bellman::weighted_sum(counts.data(), indices.data(), v.data(), n) - weighted) < 1e-12 );
+
+        double sum, sum_squares, expected_sum = 0, expected_sum_squares = 0;
+        for (int k = 0; k < n; k++)
+        {
+            expected_sum += counts[k]*(v[indices[k]] - 5.0);
+            expected_sum_squares += counts[k]*(v[indices[k]] - 5.0)*(v[indices[k]] - 5.0);
+        }
+        mdp::bellman::weighted_moments(counts.data(), indices.data(), v.data(), n, 5.0, &sum, &sum_squares);
+        REQUIRE( std::abs(sum - expected_sum) < 1e-12 );
+        REQUIRE( std::abs(sum_squares - expected_sum_squares) < 1e-10 );
+    }
+}
@@ -19,4 +19,11 @@ TEST_CASE( "Testing chain", "[chain]" )
     step_result = chain.step(0);
     step_result = chain.step(0);
     REQUIRE( (chain.state == 2 && step_result.reward == 1.0) );
+    REQUIRE( step_result.done );
+    REQUIRE( chain.is_terminal(2) );
+    REQUIRE( !chain.is_terminal(1) );
+
+    chain.set_terminal_states({1});
+    REQUIRE( chain.is_terminal(1) );
+    REQUIRE( !chain.is_terminal(2) );
 }
\ No newline at end of file
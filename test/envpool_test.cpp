@@ -0,0 +1,178 @@
+#include <vector>
+#include <thread>
+#include <memory>
+#include <stdexcept>
+#include "catch.hpp"
+#include "mdp.h"
+#include "parallel.h"
+
+TEST_CASE( "Testing LockFreeQueue", "[lockfreequeue]" )
+{
+    utils::parallel::LockFreeQueue<int> queue(3);
+    REQUIRE( queue.capacity() == 4 );
+    REQUIRE( queue.empty() );
+    int value = -1;
+    REQUIRE( !queue.pop(value) );
+    for (int i = 0; i < 4; i++) REQUIRE( queue.push(int(i)) );
+    REQUIRE( !queue.push(4) );
+    REQUIRE( queue.pop(value) );
+    REQUIRE( value == 0 );
+    REQUIRE( queue.push(4) );
+    for (int i = 1; i < 5; i++)
+    {
+        REQUIRE( queue.pop(value) );
+        REQUIRE( value == i );
+    }
+    REQUIRE( queue.empty() );
+
+    // several producers and one consumer: every value is received once, in order for each producer
+    int n_producers = 3;
+    int n_values = 20000;
+    utils::parallel::LockFreeQueue<int> shared_queue(64);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < n_producers; p++)
+    {
+        producers.push_back(std::thread([&shared_queue, p, n_values]()
+        {
+            for (int i = 0; i < n_values; i++)
+            {
+                while (!shared_queue.push(p*n_values + i)) std::this_thread::yield();
+            }
+        }));
+    }
+    std::vector<int> last(n_producers, -1);
+    bool in_order = true;
+    for (int received = 0; received < n_producers*n_values;)
+    {
+        if (!shared_queue.pop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        int p = value / n_values;
+        in_order = in_order && (value % n_values == last[p] + 1);
+        last[p] = value % n_values;
+        received++;
+    }
+    for (std::thread& producer: producers) producer.join();
+    REQUIRE( in_order );
+    REQUIRE( shared_queue.empty() );
+}
+
+TEST_CASE( "Testing EnvPool", "[envpool]" )
+{
+    int n_envs = 7;
+    auto make_gridworld = [](int i)
+    {
+        std::shared_ptr<mdp::GridWorld> env = std::make_shared<mdp::GridWorld>(4, 4, 0.3, 0, 0.1);
+        env->set_seed(i + 1);
+        return env;
+    };
+    mdp::EnvPool<mdp::GridWorld> pool(make_gridworld, n_envs, 3);
+    REQUIRE( pool.size() == n_envs );
+    REQUIRE( pool.n_threads() == 3 );
+    REQUIRE( pool.n_pending() == 0 );
+
+    // reference trajectories, computed sequentially
+    std::vector<std::shared_ptr<mdp::GridWorld>> reference;
+    for (int i = 0; i < n_envs; i++) reference.push_back(make_gridworld(i));
+    auto policy = [](int i, int state, int t) { return (state + i + t) % 4; };
+
+    std::vector<mdp::EnvStep<int>> steps;
+    pool.reset();
+    REQUIRE( pool.n_pending() == n_envs );
+    REQUIRE( pool.recv(steps, n_envs) == n_envs );
+    REQUIRE( pool.n_pending() == 0 );
+
+    std::vector<int> states(n_envs), counts(n_envs, 0);
+    for (const mdp::EnvStep<int>& step: steps)
+    {
+        REQUIRE( step.reset );
+        REQUIRE( step.state == reference[step.env]->reset() );
+        states[step.env] = step.state;
+    }
+    for (int i = 0; i < n_envs; i++) pool.send(i, policy(i, states[i], 0));
+
+    // asynchronous loop: act as soon as a step of an environment is completed
+    bool same = true;
+    int n_steps = 0;
+    while (n_steps < 100*n_envs)
+    {
+        pool.recv(steps);
+        for (const mdp::EnvStep<int>& step: steps)
+        {
+            int i = step.env;
+            mdp::StepResult<int> expected = reference[i]->step(policy(i, states[i], counts[i]));
+            int expected_state = expected.done ? reference[i]->reset() : expected.next_state;
+            same = same && !step.reset && (step.result.next_state == expected.next_state)
+                        && (step.result.reward == expected.reward) && (step.result.done == expected.done)
+                        && (step.state == expected_state);
+            states[i] = step.state;
+            counts[i]++;
+            n_steps++;
+            if (counts[i] < 100) pool.send(i, policy(i, states[i], counts[i]));
+        }
+    }
+    REQUIRE( same );
+    REQUIRE( pool.n_pending() == 0 );
+    for (int i = 0; i < n_envs; i++) REQUIRE( pool.get_env(i).state == reference[i]->state );
+}
+
+TEST_CASE( "Testing EnvPool with batched actions and different environments", "[envpool]" )
+{
+    typedef mdp::MDP<int, int> FiniteEnv;
+    auto make_env = [](int i) -> std::shared_ptr<FiniteEnv>
+    {
+        if (i % 2 == 0) return std::make_shared<mdp::Chain>(3);
+        return std::make_shared<mdp::GridWorld>(2, 2);
+    };
+    mdp::EnvPool<FiniteEnv> pool(make_env, 4, 2, false);
+    REQUIRE( dynamic_cast<mdp::Chain*>(&pool.get_env(0)) != nullptr );
+    REQUIRE( dynamic_cast<mdp::GridWorld*>(&pool.get_env(1)) != nullptr );
+
+    std::vector<int> envs = {3, 2, 1, 0};
+    std::vector<int> actions = {0, 0, 0, 0};
+    std::vector<mdp::EnvStep<int>> steps;
+    pool.send(envs.data(), actions.data(), 4);
+    REQUIRE( pool.recv(steps, 4) == 4 );
+    pool.send(envs.data(), actions.data(), 4);
+
+    // one pending action per environment, checked in all builds
+    REQUIRE_THROWS_AS( pool.send(2, 0), std::logic_error );
+    REQUIRE_THROWS_AS( pool.reset(), std::logic_error );
+    REQUIRE_THROWS_AS( pool.send(4, 0), std::logic_error );
+    REQUIRE( pool.n_pending() == 4 );
+    REQUIRE( pool.recv(steps, 4) == 4 );
+    for (const mdp::EnvStep<int>& step: steps)
+    {
+        if (step.env % 2 == 0)
+        {
+            // chain 0 -> 1 -> 2 (terminal), not reset since auto_reset = false
+            REQUIRE( step.result.next_state == 2 );
+            REQUIRE( step.result.done );
+            REQUIRE( step.state == 2 );
+        }
+    }
+
+    // continuous states
+    auto make_mountain_car = [](int i)
+    {
+        std::shared_ptr<mdp::MountainCar> env = std::make_shared<mdp::MountainCar>();
+        env->randgen.set_seed(i + 1);
+        return env;
+    };
+    mdp::EnvPool<mdp::MountainCar> car_pool(make_mountain_car, 3, 0, true, true);
+#ifdef __linux__
+    REQUIRE( car_pool.n_pinned_threads() == car_pool.n_threads() );
+#endif
+    mdp::MountainCar reference;
+    std::vector<mdp::EnvStep<mdp::StaticState<2>>> car_steps;
+    reference.randgen.set_seed(2);
+    car_pool.reset(1);
+    REQUIRE( car_pool.recv(car_steps, 1) == 1 );
+    REQUIRE( car_steps[0].env == 1 );
+    REQUIRE( car_steps[0].state == reference.reset() );
+    car_pool.send(1, 2);
+    REQUIRE( car_pool.recv(car_steps) == 1 );
+    REQUIRE( car_steps[0].result.next_state == reference.step(2).next_state );
+}
@@ -0,0 +1,46 @@
+#include <vector>
+#include "catch.hpp"
+#include "mdp.h"
+
+TEST_CASE( "Testing EpisodicVI on chain", "[episodicvi]" )
+{
+    mdp::Chain chain(4);
+    int horizon = 5;
+    mdp::EpisodicVI vi(chain, horizon);
+    vi.run();
+
+    // going right reaches the last state after 3 steps, then the agent stays there by going right
+    REQUIRE( vi.V[0][0] == 3.0 );
+    REQUIRE( vi.V[horizon - 1][3] == 1.0 );
+    REQUIRE( vi.greedy_policy[0][0] == 0 );
+
+    // the value of the greedy policy is the optimal value
+    utils::vec::vec_2d Vpi = utils::vec::get_zeros_2d(horizon + 1, chain.ns);
+    vi.evaluate_policy(vi.greedy_policy, Vpi);
+    REQUIRE( Vpi == vi.V );
+}
+
+TEST_CASE( "Testing multithreaded EpisodicVI", "[episodicvi_parallel]" )
+{
+    mdp::GridWorld mdp(15, 20, 0.2, 0.5);
+    int horizon = 20;
+
+    mdp::EpisodicVI serial(mdp, horizon);
+    serial.run();
+    utils::vec::vec_2d Vpi_serial = utils::vec::get_zeros_2d(horizon + 1, mdp.ns);
+    serial.evaluate_policy(serial.greedy_policy, Vpi_serial);
+
+    for(utils::parallel::schedule_type schedule: {utils::parallel::static_schedule, utils::parallel::dynamic_schedule})
+    {
+        mdp::EpisodicVI parallel(mdp, horizon);
+        parallel.set_num_threads(4, schedule, 7);
+        parallel.run();
+        utils::vec::vec_2d Vpi = utils::vec::get_zeros_2d(horizon + 1, mdp.ns);
+        parallel.evaluate_policy(serial.greedy_policy, Vpi);
+
+        // results are bit-identical
+        REQUIRE( parallel.V == serial.V );
+        REQUIRE( parallel.greedy_policy == serial.greedy_policy );
+        REQUIRE( Vpi == Vpi_serial );
+    }
+}
@@ -0,0 +1,135 @@
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include "catch.hpp"
+#include "mdp.h"
+#include "ucbvi.h"
+#include "experimentrunner.h"
+#include "utils.h"
+
+TEST_CASE( "Testing TaskPool", "[task_pool]" )
+{
+    utils::parallel::TaskPool pool(4);
+    REQUIRE( pool.size() == 4 );
+    std::atomic<int> count(0);
+    std::vector<int> done(100, 0);
+    for (int i = 0; i < 10; i++)
+    {
+        // tasks submitted by a task go to the queue of its thread, and can be stolen by the others
+        pool.submit([&pool, &count, &done, i]()
+        {
+            for (int j = 0; j < 10; j++)
+            {
+                pool.submit([&count, &done, i, j]()
+                {
+                    done[10*i + j] += 1;
+                    count++;
+                });
+            }
+        });
+    }
+    pool.wait();
+    REQUIRE( count == 100 );
+    for (int i = 0; i < 100; i++) REQUIRE( done[i] == 1 );
+
+    // the pool can be reused
+    pool.submit([&count]() { count++; });
+    pool.wait();
+    REQUIRE( count == 101 );
+
+    // exceptions of the tasks are rethrown by wait(), after the other tasks are finished
+    for (int i = 0; i < 10; i++)
+    {
+        pool.submit([&count, i]()
+        {
+            if (i % 3 == 0) throw std::runtime_error("task failed");
+            count++;
+        });
+    }
+    REQUIRE_THROWS_AS( pool.wait(), std::runtime_error );
+    REQUIRE( count == 107 );
+    pool.wait();
+    pool.submit([]() { throw std::runtime_error("never waited for"); });
+}
+
+TEST_CASE( "Testing ExperimentRunner", "[experiment_runner]" )
+{
+    int horizon = 5;
+    int n_episodes = 30;
+    mdp::Chain reference_mdp(4, 0.1);
+    mdp::EpisodicVI vi(reference_mdp, horizon);
+    vi.run();
+    const utils::vec::vec_2d& trueV = vi.V;
+    std::vector<double> scale_factors = {0.1, 1.0};
+
+    std::atomic<int> n_finished(0);
+    std::atomic<int> n_wrong_regrets(0);
+    online::TrialFactory factory = [&](int config, unsigned seed)
+    {
+        auto chain = std::make_shared<mdp::Chain>(4, 0.1);
+        chain->set_seed(seed);
+        auto algo = std::make_shared<online::UCBVI>(*chain, horizon, scale_factors[config], "hoeffding", true, seed);
+        online::Trial trial;
+        trial.mdp = chain;
+        trial.algorithm = algo;
+        online::UCBVI* ucbvi = algo.get();
+        trial.run_episode = [ucbvi, &trueV]() { return ucbvi->run_episode(trueV); };
+        trial.episode_regret = [ucbvi, &trueV](int s) { return trueV[0][s] - ucbvi->episode_value.back(); };
+        mdp::Chain* chain_ptr = chain.get();
+        trial.finish = [&n_finished, &n_wrong_regrets, &trueV, chain_ptr, ucbvi, n_episodes, horizon]()
+        {
+            if ((int) ucbvi->episode_value.size() == n_episodes) n_finished++;
+            // regret saved in the history: trueV[0][s0] - episode_value[k] in each step of episode k
+            const mdp::History<int, int>& history = chain_ptr->history;
+            if ((int) history.states.size() != n_episodes*horizon) n_wrong_regrets++;
+            for (std::size_t t = 0; t < history.states.size(); t++)
+            {
+                int k = history.episodes[t];
+                int initial_state = history.states[k*horizon];
+                if (history.extra_variables[0].data[t] != trueV[0][initial_state] - ucbvi->episode_value[k])
+                {
+                    n_wrong_regrets++;
+                }
+            }
+        };
+        return trial;
+    };
+
+    online::ExperimentRunner runner(factory, 2, 3, n_episodes, 3);
+    runner.run();
+    REQUIRE( runner.regret.size() == 2 );
+    REQUIRE( n_finished == 6 );
+    REQUIRE( n_wrong_regrets == 0 );
+
+    // csv file: one row of zeros, then the regret after each episode
+    runner.to_csv(1, "experimentrunner_test.csv");
+    std::ifstream file("experimentrunner_test.csv");
+    std::vector<std::string> rows;
+    for (std::string row; std::getline(file, row);) rows.push_back(row);
+    std::remove("experimentrunner_test.csv");
+    REQUIRE( rows.size() == n_episodes + 1 );
+    REQUIRE( rows[0] == "0,0,0" );
+
+    // the results of each trial do not depend on the other ones
+    for (int config = 0; config < 2; config++)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            online::Trial trial = factory(config, runner.first_seed + i);
+            double total = 0;
+            for (int k = 0; k < n_episodes; k++)
+            {
+                total += trial.episode_regret(trial.run_episode());
+                REQUIRE( runner.regret[config][i][k] == total );
+            }
+        }
+        double mean = (runner.regret[config][0].back() + runner.regret[config][1].back()
+                       + runner.regret[config][2].back())/3;
+        REQUIRE( std::abs(runner.mean_regret[config].back() - mean) < 1e-12 );
+        REQUIRE( runner.std_regret[config].back() >= 0 );
+    }
+}
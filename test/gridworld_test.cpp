@@ -0,0 +1,147 @@
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+#include "catch.hpp"
+#include "mdp.h"
+
+TEST_CASE( "Testing sparse transitions of GridWorld", "[gridworld]" )
+{
+    mdp::GridWorld mdp(3, 4, 0.2);
+    REQUIRE( mdp.id.compare("GridWorld") == 0);
+    REQUIRE( mdp.ns == 12 );
+    REQUIRE( mdp.na == 4 );
+
+    bool rows_ok = true;
+    for(int s = 0; s < mdp.ns; s++)
+    {
+        for(int a = 0; a < mdp.na; a++)
+        {
+            int size = mdp.transitions.row_end(s, a) - mdp.transitions.row_begin(s, a);
+            double sum = 0;
+            for(double p: mdp.transitions.dense_row(s, a)) sum += p;
+            rows_ok = rows_ok && (size >= 1) && (size <= 4) && (std::fabs(sum - 1.0) < 1e-12);
+        }
+    }
+    REQUIRE( rows_ok );
+
+    // from the top-left corner, 'right' leads to state 1 with probability 1 - 3*0.2/4
+    REQUIRE( std::fabs(mdp.transitions.prob(0, 1, 1) - 0.85) < 1e-12 );
+    REQUIRE( mdp.transitions.prob(0, 1, 11) == 0.0 );
+}
+
+TEST_CASE( "Testing large GridWorld", "[gridworld_large]" )
+{
+    mdp::GridWorld mdp(100, 100, 0.1);
+    REQUIRE( mdp.ns == 10000 );
+    REQUIRE( mdp.transitions.nnz() <= 4*mdp.ns*mdp.na );
+
+    mdp::EpisodicVI vi(mdp, 5);
+    vi.run();
+    // the goal can only be reached in the last steps from states close to it
+    REQUIRE( vi.V[0][0] == 0.0 );
+    REQUIRE( vi.V[0][mdp.ns - 2] > 0.0 );
+}
+
+TEST_CASE( "Testing conversion from dense to sparse transitions", "[sparse_transitions]" )
+{
+    utils::vec::tensor_3d P(2, 1, 2);
+    utils::vec::tensor_3d R(2, 1, 2);
+    P(0, 0, 0) = 0.25; P(0, 0, 1) = 0.75; R(0, 0, 1) = 2.0;
+    P(1, 0, 1) = 1.0;  R(1, 0, 0) = 5.0;
+
+    mdp::FiniteMDP mdp(R, P);
+    REQUIRE( mdp.transitions.nnz() == 3 );
+    REQUIRE( mdp.transitions.prob(0, 0, 1) == 0.75 );
+    REQUIRE( mdp.transitions.reward(0, 0, 1) == 2.0 );
+    REQUIRE( mdp.transitions.reward(1, 0, 0) == 0.0 );
+    REQUIRE( mdp.reward_function.mean_rewards.empty() );
+
+    // the mean rewards are only stored in the transitions
+    utils::rand::Random randgen(1);
+    REQUIRE_THROWS_AS( mdp.reward_function.sample(0, 0, 1, randgen), std::logic_error );
+    REQUIRE_THROWS_AS( mdp::FiniteMDP(mdp::DiscreteReward(R), mdp.transitions), std::invalid_argument );
+    REQUIRE( mdp::DiscreteReward(R).sample(0, 0, 1, randgen) == 2.0 );
+
+    mdp::EpisodicVI vi(mdp, 1);
+    vi.run();
+    REQUIRE( vi.V[0][0] == 1.5 );
+    REQUIRE( vi.V[0][1] == 0.0 );
+}
+
+TEST_CASE( "Testing FiniteMDP samplers after modification of transitions", "[sampler_invalidation]" )
+{
+    utils::vec::tensor_3d P(2, 1, 2, 0.5);
+    utils::vec::tensor_3d R(2, 1, 2);
+    mdp::FiniteMDP mdp(R, P, 0, 42);
+
+    // make state 1 unreachable from state 0
+    int begin = mdp.transitions.row_begin(0, 0);
+    unsigned long stamp = mdp.transitions.stamp();
+    mdp.transitions.set_prob(begin, 1.0);
+    REQUIRE( mdp.transitions.stamp() != stamp );
+    mdp.transitions.set_prob(begin + 1, 0.0);
+
+    bool stays = true;
+    for(int i = 0; i < 100; i++)
+    {
+        mdp.reset();
+        stays = stays && (mdp.step(0).next_state == 0);
+    }
+    REQUIRE( stays );
+}
+
+TEST_CASE( "Testing reward noise in GridWorld", "[reward_noise]" )
+{
+    mdp::GridWorld mdp(2, 2, 0.0, 0.0, 0.1);
+    REQUIRE( mdp.reward_function.noise == mdp::DiscreteReward::gaussian );
+
+    // going left from the top-left corner: the mean reward is 0, the noise must change at each step
+    double r1 = mdp.step(0).reward;
+    double r2 = mdp.step(0).reward;
+    REQUIRE( mdp.state == 0 );
+    REQUIRE( r1 != r2 );
+
+    utils::rand::Random randgen(42);
+    std::vector<double> rewards(1000, 1.0);
+    mdp.reward_function.add_noise(rewards.data(), rewards.size(), randgen);
+    REQUIRE( std::fabs(utils::vec::mean(rewards) - 1.0) < 0.02 );
+    REQUIRE( std::fabs(utils::vec::stdev(rewards) - 0.1) < 0.02 );
+
+    mdp::DiscreteReward no_noise;
+    REQUIRE( no_noise.noise == mdp::DiscreteReward::none );
+    REQUIRE( no_noise.sample_noise(randgen) == 0.0 );
+}
+
+TEST_CASE( "Testing step_into and step_batch of GridWorld", "[gridworld]" )
+{
+    REQUIRE( mdp::StepResult<int>().next_state == -1 );
+
+    mdp::GridWorld reference(4, 4, 0.3, 0, 0.1);
+    mdp::GridWorld env(4, 4, 0.3, 0, 0.1);
+    reference.set_seed(11);
+    env.set_seed(11);
+    mdp::MDP<int, int>& base = env;
+
+    std::vector<int> actions(50);
+    for(int t = 0; t < 50; t++) actions[t] = (3*t) % 4;
+
+    bool same = true;
+    mdp::StepResult<int> out;
+    std::vector<mdp::StepResult<int>> batch(actions.size());
+    for(int t = 0; t < 50; t++)
+    {
+        mdp::StepResult<int> expected = reference.step(actions[t]);
+        base.step_into(actions[t], out);
+        same = same && (out.next_state == expected.next_state) && (out.reward == expected.reward)
+                    && (out.done == expected.done) && (env.state == reference.state);
+    }
+    base.step_batch(actions.data(), actions.size(), batch.data());
+    for(int t = 0; t < 50; t++)
+    {
+        mdp::StepResult<int> expected = reference.step(actions[t]);
+        same = same && (batch[t].next_state == expected.next_state) && (batch[t].reward == expected.reward)
+                    && (batch[t].done == expected.done);
+    }
+    REQUIRE( same );
+    REQUIRE( env.state == reference.state );
+}
@@ -0,0 +1,123 @@
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include "catch.hpp"
+#include "mdp.h"
+
+namespace
+{
+    std::string read_file(const std::string& filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        std::stringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    /**
+     * Previous implementation of History<int, int>::to_csv(), with std::ofstream
+     */
+    void to_csv_with_ofstream(const mdp::History<int, int>& history, const std::string& filename)
+    {
+        std::ofstream file(filename);
+        file << "episode,state,action,next_state, reward,";
+        for (unsigned int j = 0; j < history.n_extra_variables; j++) file << history.extra_variables[j].name << ",";
+        file << "\n";
+        for (unsigned int i = 0; i < history.length; i++)
+        {
+            file << history.episodes[i] << "," << history.states[i] << "," << history.actions[i] << ","
+                 << history.next_states[i] << "," << history.rewards[i] << ",";
+            for (unsigned int j = 0; j < history.n_extra_variables; j++) file << history.extra_variables[j].data[i] << ",";
+            file << "\n";
+        }
+    }
+}
+
+TEST_CASE( "Testing binary history files", "[history]" )
+{
+    mdp::GridWorld mdp(4, 4, 0.2, 0, 0.5);
+    mdp.set_seed(5);
+    mdp::History<int, int> history(0, 2);
+    history.set_names({"value", "bonus"});
+    std::vector<double> special = {0.0, -0.0, 1e6, -123456.0, 1e-7, 0.1, 2.5e300, -1.0/3};
+    int state = mdp.reset();
+    for (int t = 0; t < 1000; t++)
+    {
+        int action = t % 4;
+        mdp::StepResult<int> result = mdp.step(action);
+        history.append(state, action, result.reward, result.next_state,
+                       {special[t % special.size()], 1.0*t}, t / 100 - 3);
+        state = result.next_state;
+    }
+
+    std::string binary_file = "history_test.bin";
+    std::string csv_file = "history_test.csv";
+    std::string reference_csv_file = "history_test_reference.csv";
+    history.to_binary(binary_file);
+
+    {
+        mdp::HistoryReader reader(binary_file);
+        REQUIRE( reader.is_open() );
+        REQUIRE( reader.length() == 1000 );
+        REQUIRE( reader.n_extra_variables() == 2 );
+        REQUIRE( reader.extra_name(0) == "value" );
+        REQUIRE( reader.extra_name(1) == "bonus" );
+        REQUIRE( std::vector<int>(reader.episodes().begin(), reader.episodes().end()) == history.episodes );
+        REQUIRE( std::vector<int>(reader.states().begin(), reader.states().end()) == history.states );
+        REQUIRE( std::vector<int>(reader.actions().begin(), reader.actions().end()) == history.actions );
+        REQUIRE( std::vector<int>(reader.next_states().begin(), reader.next_states().end()) == history.next_states );
+        REQUIRE( std::vector<double>(reader.rewards().begin(), reader.rewards().end()) == history.rewards );
+        REQUIRE( std::vector<double>(reader.extra_variable(1).begin(), reader.extra_variable(1).end())
+                 == history.extra_variables[1].data );
+        // columns are aligned in the mapped file
+        REQUIRE( ((std::size_t) reader.rewards().data()) % 64 == 0 );
+
+        mdp::History<int, int> copy;
+        reader.to_history(copy);
+        REQUIRE( copy.length == history.length );
+        REQUIRE( copy.states == history.states );
+        REQUIRE( copy.extra_variables[0].name == "value" );
+        REQUIRE( copy.extra_variables[0].data == history.extra_variables[0].data );
+
+        // csv files are the same as the ones written with std::ofstream
+        to_csv_with_ofstream(history, reference_csv_file);
+        REQUIRE( reader.to_csv(csv_file) );
+        REQUIRE( read_file(csv_file) == read_file(reference_csv_file) );
+        history.to_csv(csv_file);
+        REQUIRE( read_file(csv_file) == read_file(reference_csv_file) );
+    }
+
+    // empty history
+    mdp::History<int, int> empty;
+    empty.to_binary(binary_file);
+    mdp::HistoryReader empty_reader(binary_file);
+    REQUIRE( empty_reader.is_open() );
+    REQUIRE( empty_reader.length() == 0 );
+    REQUIRE( empty_reader.n_extra_variables() == 0 );
+
+    // invalid files
+    mdp::HistoryReader csv_reader(csv_file);
+    REQUIRE( !csv_reader.is_open() );
+    mdp::HistoryReader missing_reader("missing_history_file.bin");
+    REQUIRE( !missing_reader.is_open() );
+
+    // corrupt header: huge number of columns in a 24-byte file
+    {
+        std::ofstream file(binary_file, std::ios::binary);
+        std::uint32_t version = 1, n_columns = 0xFFFFFFF0;
+        std::uint64_t length = 10;
+        file.write("RLCPPHST", 8);
+        file.write((const char*) &version, sizeof(version));
+        file.write((const char*) &n_columns, sizeof(n_columns));
+        file.write((const char*) &length, sizeof(length));
+    }
+    mdp::HistoryReader corrupt_reader(binary_file);
+    REQUIRE( !corrupt_reader.is_open() );
+
+    std::remove(binary_file.c_str());
+    std::remove(csv_file.c_str());
+    std::remove(reference_csv_file.c_str());
+}
@@ -0,0 +1,134 @@
+#include <vector>
+#include <cmath>
+#include "catch.hpp"
+#include "mdp.h"
+
+TEST_CASE( "Testing MountainCar", "[mountaincar]" )
+{
+    mdp::MountainCar env;
+    REQUIRE( env.id == "MountainCar" );
+    REQUIRE( env.na == 3 );
+    REQUIRE( mdp::MountainCar::dimension == 2 );
+
+    mdp::StaticState<2> state = env.reset();
+    REQUIRE( (state[0] >= -1.2 && state[0] <= 0.6) );
+    REQUIRE( state[1] == 0 );
+
+    // reaching the goal from the right of the hill
+    env.state = {0.55, 0.05};
+    mdp::StepResult<mdp::StaticState<2>> result = env.step(2);
+    REQUIRE( result.next_state[0] == 0.6 );
+    REQUIRE( result.done );
+    REQUIRE( result.reward == 1.0 );
+
+    // the velocity is set to zero at the left wall
+    env.state = {-1.19, -0.05};
+    result = env.step(0);
+    REQUIRE( result.next_state[0] == -1.2 );
+    REQUIRE( result.next_state[1] == 0 );
+    REQUIRE( !result.done );
+}
+
+TEST_CASE( "Testing MountainCar dynamics", "[mountaincar]" )
+{
+    mdp::MountainCar env;
+
+    // away from the left wall, a negative velocity is kept
+    env.state = {-0.5, -0.01};
+    double v = -0.01 + std::cos(3*(-0.5))*(-0.0025);
+    mdp::StepResult<mdp::StaticState<2>> result = env.step(1);
+    REQUIRE( result.next_state[1] == v );
+    REQUIRE( result.next_state[0] == -0.5 + v );
+    REQUIRE( result.next_state[1] < 0 );
+
+    // the step reaching the goal is the last one, and its reward is 1
+    env.state = {0.49, 0.02};
+    result = env.step(2);
+    REQUIRE( result.next_state[0] >= 0.5 );
+    REQUIRE( result.done );
+    REQUIRE( result.reward == 1.0 );
+
+    // a step from the goal position that leaves it is not terminal
+    env.state = {0.5, 0.0};
+    result = env.step(0);
+    REQUIRE( result.next_state[0] < 0.5 );
+    REQUIRE( !result.done );
+    REQUIRE( result.reward == 0.0 );
+
+    // in an episode, the only reward is the one of the last step
+    env.randgen.set_seed(5);
+    env.reset();
+    double total_reward = 0;
+    int n_steps = 0;
+    bool done = false;
+    while (!done && n_steps < 100000)
+    {
+        // push in the direction of the velocity
+        result = env.step(env.state[1] < 0 ? 0 : 2);
+        total_reward += result.reward;
+        done = result.done;
+        n_steps++;
+    }
+    REQUIRE( done );
+    REQUIRE( total_reward == 1.0 );
+    REQUIRE( env.state[0] >= 0.5 );
+}
+
+TEST_CASE( "Testing DynamicContinuousMDP", "[dynamic_continuous_mdp]" )
+{
+    mdp::DynamicContinuousMDP<mdp::MountainCar> env;
+    mdp::MountainCar reference;
+    REQUIRE( env.id == "MountainCar" );
+    REQUIRE( env.na == 3 );
+    REQUIRE( env.observation_space.low == std::vector<double>({-1.2, -0.07}) );
+
+    env.env.randgen.set_seed(7);
+    reference.randgen.set_seed(7);
+    std::vector<double> state = env.reset();
+    mdp::StaticState<2> reference_state = reference.reset();
+    REQUIRE( state == std::vector<double>({reference_state[0], reference_state[1]}) );
+    for (int t = 0; t < 100; t++)
+    {
+        int action = t % 3;
+        mdp::StepResult<std::vector<double>> result = env.step(action);
+        mdp::StepResult<mdp::StaticState<2>> reference_result = reference.step(action);
+        REQUIRE( result.next_state == std::vector<double>({reference_result.next_state[0], reference_result.next_state[1]}) );
+        REQUIRE( env.state == result.next_state );
+        REQUIRE( result.reward == reference_result.reward );
+        REQUIRE( result.done == reference_result.done );
+    }
+}
+
+TEST_CASE( "Testing step_into and step_batch_inline of MountainCar", "[mountaincar]" )
+{
+    mdp::MountainCar env, reference;
+    env.randgen.set_seed(3);
+    reference.randgen.set_seed(3);
+    env.reset();
+    reference.reset();
+
+    std::vector<int> actions(200);
+    for (int t = 0; t < 200; t++) actions[t] = (t / 20) % 3;
+    std::vector<mdp::StepResult<mdp::StaticState<2>>> batch(actions.size());
+    env.step_batch_inline(actions.data(), actions.size(), batch.data());
+
+    bool same = true;
+    for (int t = 0; t < 200; t++)
+    {
+        mdp::StepResult<mdp::StaticState<2>> expected = reference.step(actions[t]);
+        same = same && (batch[t].next_state == expected.next_state) && (batch[t].reward == expected.reward)
+                    && (batch[t].done == expected.done);
+    }
+    REQUIRE( same );
+    REQUIRE( env.state == reference.state );
+
+    // through the vector interface
+    mdp::DynamicContinuousMDP<mdp::MountainCar> dynamic_env;
+    dynamic_env.env.state = reference.state;
+    mdp::StepResult<std::vector<double>> out;
+    dynamic_env.step_into(2, out);
+    mdp::StepResult<mdp::StaticState<2>> expected = reference.step(2);
+    REQUIRE( out.next_state == std::vector<double>({expected.next_state[0], expected.next_state[1]}) );
+    REQUIRE( dynamic_env.state == out.next_state );
+    REQUIRE( out.done == expected.done );
+}
@@ -0,0 +1,58 @@
+#include <vector>
+#include <cmath>
+#include "catch.hpp"
+#include "mdp.h"
+
+TEST_CASE( "Testing policy iteration on chain", "[policyiteration]" )
+{
+    mdp::Chain chain(4);
+    double gamma = 0.9;
+
+    for (mdp::evaluation_solver solver : {mdp::gauss_seidel_solver, mdp::sor_solver, mdp::bicgstab_solver})
+    {
+        mdp::PolicyIteration pi(chain, gamma, 1e-10);
+        pi.solver = solver;
+        pi.run();
+
+        // going right reaches the last state after 3 steps, then the agent stays there by going right
+        REQUIRE( pi.converged );
+        REQUIRE( pi.policy == std::vector<int>(4, 0) );
+        REQUIRE( std::abs(pi.V[3] - 1/(1 - gamma)) < 1e-9 );
+        REQUIRE( std::abs(pi.V[0] - gamma*gamma/(1 - gamma)) < 1e-9 );
+    }
+}
+
+TEST_CASE( "Testing policy iteration solvers against value iteration", "[policyiteration_solvers]" )
+{
+    mdp::GridWorld mdp(10, 12, 0.1, 0.2);
+    double gamma = 0.95;
+
+    mdp::ValueIteration vi(mdp, gamma, 1e-10);
+    vi.sweep_order = mdp::jacobi;
+    vi.run();
+
+    for (mdp::evaluation_solver solver : {mdp::gauss_seidel_solver, mdp::sor_solver, mdp::bicgstab_solver})
+    {
+        mdp::PolicyIteration pi(mdp, gamma, 1e-10);
+        pi.solver = solver;
+        pi.run();
+        REQUIRE( pi.converged );
+        REQUIRE( pi.iterations < vi.iterations );
+        for (int s = 0; s < mdp.ns; s++) REQUIRE( std::abs(pi.V[s] - vi.V[s]) < 1e-8 );
+
+        // evaluation of a fixed policy: the solvers agree
+        std::vector<double> Vpi(mdp.ns, 0.0);
+        pi.evaluate_policy(std::vector<int>(mdp.ns, 1), Vpi);
+        mdp::PolicyIteration reference(mdp, gamma, 1e-12);
+        std::vector<double> Vref(mdp.ns, 0.0);
+        reference.evaluate_policy(std::vector<int>(mdp.ns, 1), Vref);
+        for (int s = 0; s < mdp.ns; s++) REQUIRE( std::abs(Vpi[s] - Vref[s]) < 1e-9 );
+    }
+
+    // modified policy iteration
+    mdp::PolicyIteration mpi(mdp, gamma, 1e-10);
+    mpi.evaluation_sweeps = 5;
+    mpi.run();
+    REQUIRE( mpi.converged );
+    REQUIRE( mpi.policy == vi.greedy_policy );
+}
@@ -1,4 +1,5 @@
 #include <vector>
+#include <cmath>
 #include "catch.hpp"
 #include "random.h"
 
@@ -37,4 +38,184 @@ TEST_CASE( "Testing Random::choice", "[choice]" )
         prob_unchanged = prob_unchanged && (prob[i] == prob_backup[i]);
     }
     REQUIRE( prob_unchanged );
-}
\ No newline at end of file
+}
+
+TEST_CASE( "Testing alias tables", "[alias]" )
+{
+    utils::rand::Random randgen(42);
+    std::vector<double> prob = {0.1, 0.0, 0.2, 0.3, 0.4};
+    int n = prob.size();
+    std::vector<double> alias_prob(n);
+    std::vector<int> alias_index(n);
+    utils::rand::build_alias_table(prob.data(), n, alias_prob.data(), alias_index.data());
+
+    int n_samples = 100000;
+    std::vector<double> freq(n, 0.0);
+    for(int i = 0; i < n_samples; i++)
+    {
+        freq[randgen.sample_alias(alias_prob.data(), alias_index.data(), n)] += 1.0/n_samples;
+    }
+
+    REQUIRE( freq[1] == 0.0 );
+    bool close = true;
+    for(int i = 0; i < n; i++) close = close && (std::fabs(freq[i] - prob[i]) < 0.01);
+    REQUIRE( close );
+}
+
+
+TEST_CASE( "Testing CategoricalSampler", "[categorical_sampler]" )
+{
+    utils::rand::Random randgen(42);
+
+    // small distribution (linear scan) and large distribution (binary search)
+    std::vector<double> prob_small = {0.1, 0.2, 0.3, 0.4};
+    std::vector<double> prob_large(50, 0.0);
+    for(int i = 0; i < 50; i++) prob_large[i] = (i % 3 == 0) ? 0.0 : 1.0/33;
+    prob_large[49] = 1.0 - 32.0/33;
+
+    for(std::vector<double>* prob: {&prob_small, &prob_large})
+    {
+        utils::rand::CategoricalSampler sampler(*prob);
+        REQUIRE( sampler.size() == (int) prob->size() );
+        bool same_as_choice = true;
+        for(int i = 0; i <= 1000; i++)
+        {
+            double u = i/1000.0;
+            same_as_choice = same_as_choice && (sampler.sample(u) == randgen.choice(*prob, u));
+        }
+        REQUIRE( same_as_choice );
+    }
+
+    utils::rand::CategoricalSampler sampler(prob_small);
+    REQUIRE( sampler.sample(0.10001) == 1 );
+    REQUIRE( sampler.sample(0.59999) == 2 );
+    REQUIRE( sampler.sample(1.0) == 3 );
+
+    std::vector<int> samples(20000);
+    sampler.sample_n(samples.data(), samples.size(), randgen);
+    std::vector<double> freq(4, 0.0);
+    for(int sample: samples) freq[sample] += 1.0/samples.size();
+    bool close = true;
+    for(int i = 0; i < 4; i++) close = close && (std::fabs(freq[i] - prob_small[i]) < 0.02);
+    REQUIRE( close );
+}
+
+TEST_CASE( "Testing Philox4x32", "[philox]" )
+{
+    // known answers of Philox4x32-10 (Random123)
+    std::uint32_t out[4];
+    std::uint32_t counter0[4] = {0, 0, 0, 0};
+    std::uint32_t key0[2] = {0, 0};
+    utils::rand::Philox4x32::block(counter0, key0, out);
+    REQUIRE( out[0] == 0x6627e8d5u );
+    REQUIRE( out[1] == 0xe169c58du );
+    REQUIRE( out[2] == 0xbc57ac4cu );
+    REQUIRE( out[3] == 0x9b00dbd8u );
+
+    std::uint32_t counter1[4] = {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u};
+    std::uint32_t key1[2] = {0xa4093822u, 0x299f31d0u};
+    utils::rand::Philox4x32::block(counter1, key1, out);
+    REQUIRE( out[0] == 0xd16cfe09u );
+    REQUIRE( out[1] == 0x94fdccebu );
+    REQUIRE( out[2] == 0x5001e420u );
+    REQUIRE( out[3] == 0x24126ea1u );
+
+    // discard(n) is equivalent to n calls
+    utils::rand::Philox4x32 engine(7, 3, 11);
+    utils::rand::Philox4x32 skipped(7, 3, 11);
+    std::vector<std::uint32_t> values(1000);
+    for (int i = 0; i < 1000; i++) values[i] = engine();
+    skipped.discard(1);
+    REQUIRE( skipped() == values[1] );
+    skipped.discard(500);
+    REQUIRE( skipped() == values[502] );
+    skipped.discard(5);
+    REQUIRE( skipped() == values[508] );
+
+    // other streams and substreams give other sequences
+    utils::rand::Philox4x32 other_stream(7, 4, 11);
+    utils::rand::Philox4x32 other_substream(7, 3, 12);
+    REQUIRE( other_stream() != values[0] );
+    REQUIRE( other_substream() != values[0] );
+
+    // uniform samples use the next two outputs, and are in [0, 1) with mean close to 1/2
+    utils::rand::Philox4x32 uniform_engine(7, 3, 11);
+    REQUIRE( utils::rand::uniform(uniform_engine) == ((values[0] >> 5)*67108864.0 + (values[1] >> 6))/9007199254740992.0 );
+    REQUIRE( uniform_engine() == values[2] );
+    double mean = 0;
+    bool in_range = true;
+    for (int i = 0; i < 10000; i++)
+    {
+        double u = utils::rand::uniform(uniform_engine);
+        in_range = in_range && (u >= 0 && u < 1);
+        mean += u/10000;
+    }
+    REQUIRE( in_range );
+    REQUIRE( std::abs(mean - 0.5) < 0.02 );
+}
+
+template <typename RandomType>
+void check_streams()
+{
+    RandomType randgen(42);
+    std::vector<double> first(10);
+    for (int i = 0; i < 10; i++) first[i] = randgen.sample_real_uniform(0, 1);
+
+    // a stream is reproducible, and split() does not change the original object
+    RandomType stream1 = randgen.split(1, 5);
+    RandomType stream1_copy = randgen.split(1, 5);
+    double x = stream1.sample_gaussian(0, 1);
+    REQUIRE( x == stream1_copy.sample_gaussian(0, 1) );
+    double next = randgen.sample_real_uniform(0, 1);
+
+    randgen.set_stream(0);
+    for (int i = 0; i < 10; i++) REQUIRE( randgen.sample_real_uniform(0, 1) == first[i] );
+    REQUIRE( randgen.sample_real_uniform(0, 1) == next );
+
+    // another stream gives other values
+    RandomType stream2 = randgen.split(2, 5);
+    REQUIRE( stream2.sample_real_uniform(0, 1) != stream1.split(1, 5).sample_real_uniform(0, 1) );
+
+    // samples are in (0, 1) with mean close to 1/2
+    double mean = 0;
+    for (int i = 0; i < 10000; i++)
+    {
+        double u = stream2.sample_real_uniform(0, 1);
+        REQUIRE( (u >= 0 && u < 1) );
+        mean += u/10000;
+    }
+    REQUIRE( std::abs(mean - 0.5) < 0.02 );
+}
+
+TEST_CASE( "Testing Random streams", "[random_streams]" )
+{
+    check_streams<utils::rand::Random>();
+    check_streams<utils::rand::PhiloxRandom>();
+
+    // the state of a PhiloxRandom is small
+    REQUIRE( sizeof(utils::rand::PhiloxRandom) < 256 );
+
+    // with the default generator, the sequence of stream 0 is the one of std::mt19937
+    utils::rand::Random randgen(42);
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> dist;
+    randgen.set_stream(3);
+    randgen.set_stream(0);
+    REQUIRE( randgen.sample_real_uniform(0, 1) == dist(generator) );
+}
+
+TEST_CASE( "Testing default seeds", "[default_seed]" )
+{
+    utils::rand::set_default_seed(4);
+    std::vector<int> seeds;
+    for (int i = 0; i < 100; i++)
+    {
+        seeds.push_back(utils::rand::default_seed());
+        REQUIRE( (seeds.back() >= 1 && seeds.back() < (1 << 30)) );
+    }
+    REQUIRE( seeds[0] != seeds[1] );
+
+    // the sequence is reproducible
+    utils::rand::set_default_seed(4);
+    for (int i = 0; i < 100; i++) REQUIRE( utils::rand::default_seed() == seeds[i] );
+}
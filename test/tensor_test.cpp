@@ -0,0 +1,44 @@
+#include <vector>
+#include <cstdint>
+#include "catch.hpp"
+#include "tensor.h"
+#include "vector_op.h"
+
+TEST_CASE( "Testing Tensor3d indexing and views", "[tensor]" )
+{
+    utils::vec::tensor_3d tensor(3, 2, 5);
+    REQUIRE( tensor.dim1() == 3 );
+    REQUIRE( tensor.dim2() == 2 );
+    REQUIRE( tensor.dim3() == 5 );
+
+    tensor(2, 1, 4) = 1.5;
+    tensor[1][0][3] = 2.5;
+    REQUIRE( tensor[2][1][4] == 1.5 );
+    REQUIRE( tensor(1, 0, 3) == 2.5 );
+    REQUIRE( tensor.row(1, 0)[3] == 2.5 );
+    REQUIRE( tensor.row(0, 0).size() == 5 );
+
+    // each row starts on a 64-byte boundary
+    bool aligned = true;
+    for(int i = 0; i < 3; i++)
+        for(int j = 0; j < 2; j++)
+            aligned = aligned && (reinterpret_cast<std::uintptr_t>(tensor.row(i, j).data()) % 64 == 0);
+    REQUIRE( aligned );
+}
+
+TEST_CASE( "Testing Tensor3d conversion from and to nested vectors", "[tensor_conversion]" )
+{
+    utils::vec::vec_3d nested = utils::vec::get_zeros_3d(2, 3, 4);
+    nested[1][2][3] = 7.0;
+    nested[0][1][0] = -1.0;
+
+    utils::vec::tensor_3d tensor = nested;
+    REQUIRE( tensor(1, 2, 3) == 7.0 );
+    REQUIRE( tensor(0, 1, 0) == -1.0 );
+    REQUIRE( tensor(0, 0, 0) == 0.0 );
+    REQUIRE( tensor.to_nested() == nested );
+
+    utils::vec::itensor_3d itensor(2, 2, 2, 3);
+    REQUIRE( itensor(1, 1, 1) == 3 );
+    REQUIRE( itensor.row(0, 1).to_vector() == std::vector<int>({3, 3}) );
+}
@@ -0,0 +1,125 @@
+#include <vector>
+#include <cmath>
+#include "catch.hpp"
+#include "mdp.h"
+#include "ucbvi.h"
+
+TEST_CASE( "Testing incremental planning in UCBVI", "[ucbvi_incremental]" )
+{
+    mdp::GridWorld mdp(6, 6, 0.2, 0.1);
+    int horizon = 10;
+    long full_backups = ((long) horizon)*mdp.ns*mdp.na;
+
+    for (std::string b_type : {"hoeffding", "bernstein"})
+    {
+        online::UCBVI algo(mdp, horizon, 0.1, b_type, false);
+        algo.incremental_planning = true;
+        for (int k = 0; k < 30; k++)
+        {
+            // plan from the same data with a full sweep
+            online::UCBVI reference = algo;
+            reference.incremental_planning = false;
+            reference.get_optimistic_q();
+
+            algo.get_optimistic_q();
+            if (k == 1) REQUIRE( algo.planning_backups == full_backups );
+            if (k > 1) REQUIRE( algo.planning_backups < full_backups );
+
+            // the tie-breaking noise only depends on (h, s, a): both sweeps give the same values
+            for (int h = 0; h < horizon; h++)
+                for (int s = 0; s < mdp.ns; s++)
+                {
+                    REQUIRE( algo.V[h][s] == reference.V[h][s] );
+                    for (int a = 0; a < mdp.na; a++)
+                        REQUIRE( algo.Q(h, s, a) == reference.Q(h, s, a) );
+                }
+            algo.run_episode();
+        }
+
+        // changing the bonus parameters triggers a full sweep
+        algo.scale_factor = 0.2;
+        algo.get_optimistic_q();
+        REQUIRE( algo.planning_backups == full_backups );
+    }
+}
+
+TEST_CASE( "Testing rarely switching UCBVI", "[ucbvi_rarely_switching]" )
+{
+    mdp::GridWorld mdp(5, 5, 0.2, 0.1);
+    int horizon = 8;
+    int n_episodes = 400;
+
+    online::UCBVI algo(mdp, horizon, 0.1, "hoeffding", false);
+    algo.rarely_switching = true;
+    for (int k = 0; k < n_episodes; k++)
+    {
+        algo.run_episode();
+
+        // the recorded value is the value of the policy used in the episode
+        utils::vec::vec_2d Vpi = utils::vec::get_zeros_2d(horizon + 1, mdp.ns);
+        algo.VI.evaluate_policy(algo.policy, Vpi);
+        REQUIRE( std::abs(algo.episode_value[k] - Vpi[0][mdp.reset()]) < 1e-12 );
+    }
+    REQUIRE( (int) algo.episode_value.size() == n_episodes );
+    // at most log2(K) + 1 replannings triggered by each pair, plus the first one
+    REQUIRE( algo.n_replans <= 1 + mdp.ns*mdp.na*(1 + (int) std::log2(n_episodes*horizon)) );
+    REQUIRE( algo.n_replans < n_episodes/2 );
+}
+
+TEST_CASE( "Testing UCBVI estimates", "[ucbvi_estimates]" )
+{
+    mdp::Chain mdp(3);
+    online::UCBVI algo(mdp, 4, 1.0, "hoeffding", false);
+    algo.update(0, 0, 1.0, 1);
+    algo.update(0, 0, 0.0, 1);
+    algo.update(0, 0, 0.5, 0);
+    algo.update(0, 0, 0.5, 2);
+
+    REQUIRE( algo.N_sa[0][0] == 4 );
+    REQUIRE( algo.phat(0, 0, 0) == 0.25 );
+    REQUIRE( algo.phat(0, 0, 1) == 0.5 );
+    REQUIRE( algo.phat(0, 0, 2) == 0.25 );
+    REQUIRE( algo.rhat(0, 0) == 0.5 );
+    REQUIRE( algo.n_sas(0, 0, 1) == 2 );
+    // only the observed transitions are stored
+    REQUIRE( algo.successors[0] == std::vector<int>({1, 0, 2}) );
+    REQUIRE( algo.successor_counts[0] == std::vector<int>({2, 1, 1}) );
+    REQUIRE( algo.successors[1].empty() );
+
+    // bonuses, from the number of visits
+    double L = std::log(5 * mdp.ns * mdp.na * 4 / 0.1);
+    REQUIRE( std::abs(algo.hoeffding_bonus(0, 0) - 7 * 4 * L / 2) < 1e-12 );
+    REQUIRE( std::abs(algo.bernstein_bonus(0, 0, 0.5) - (std::sqrt(8 * L * 0.5 / 4) + 14 * L * 4 / 12 + std::sqrt(8 * 16 / 4.0))) < 1e-12 );
+    algo.scale_factor = 0.5;
+    REQUIRE( std::abs(algo.hoeffding_bonus(0, 0) - 0.5 * 7 * 4 * L / 2) < 1e-12 );
+    L = std::log(5 * mdp.ns * mdp.na / 0.1);
+    REQUIRE( std::abs(algo.hoeffding_bonus(1, 0) - 0.5 * 7 * 4 * L) < 1e-12 );
+    // unvisited pairs have zero estimates
+    REQUIRE( algo.phat(1, 0, 2) == 0 );
+    REQUIRE( algo.rhat(1, 0) == 0 );
+}
+
+TEST_CASE( "Testing UCBVI reproducibility", "[ucbvi_seed]" )
+{
+    int horizon = 6;
+    std::vector<utils::vec::tensor_3d> Q;
+    for (unsigned seed : {7u, 7u, 8u})
+    {
+        mdp::GridWorld mdp(4, 4, 0.2, 0.1);
+        mdp.set_seed(123);
+        online::UCBVI algo(mdp, horizon, 0.1, "bernstein", false, seed);
+        for (int k = 0; k < 20; k++) algo.run_episode();
+        Q.push_back(algo.Q);
+    }
+
+    // same seed: same episodes and identical Q functions. Another seed breaks the ties differently.
+    bool same_as_other_seed = true;
+    for (int h = 0; h < horizon; h++)
+        for (int s = 0; s < 16; s++)
+            for (int a = 0; a < 4; a++)
+            {
+                REQUIRE( Q[0](h, s, a) == Q[1](h, s, a) );
+                same_as_other_seed = same_as_other_seed && (Q[0](h, s, a) == Q[2](h, s, a));
+            }
+    REQUIRE( !same_as_other_seed );
+}
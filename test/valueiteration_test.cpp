@@ -0,0 +1,48 @@
+#include <vector>
+#include <cmath>
+#include "catch.hpp"
+#include "mdp.h"
+
+TEST_CASE( "Testing discounted value iteration on chain", "[valueiteration]" )
+{
+    mdp::Chain chain(4);
+    double gamma = 0.9;
+    double epsilon = 1e-8;
+
+    for (mdp::sweep_type order : {mdp::jacobi, mdp::gauss_seidel})
+    {
+        mdp::ValueIteration vi(chain, gamma, epsilon);
+        vi.sweep_order = order;
+        vi.run();
+
+        // going right reaches the last state after 3 steps, then the agent stays there by going right
+        REQUIRE( vi.converged );
+        REQUIRE( std::abs(vi.V[3] - 1/(1 - gamma)) < epsilon );
+        REQUIRE( std::abs(vi.V[0] - gamma*gamma/(1 - gamma)) < epsilon );
+        REQUIRE( vi.greedy_policy == std::vector<int>(4, 0) );
+        REQUIRE( vi.Q.empty() );
+    }
+}
+
+TEST_CASE( "Testing Jacobi and Gauss-Seidel value iteration", "[valueiteration_sweeps]" )
+{
+    mdp::GridWorld mdp(10, 12, 0.2, 0.5);
+    double gamma = 0.95;
+
+    mdp::ValueIteration jacobi(mdp, gamma, 1e-9);
+    jacobi.sweep_order = mdp::jacobi;
+    jacobi.store_q = true;
+    jacobi.run();
+
+    mdp::ValueIteration gauss_seidel(mdp, gamma, 1e-9);
+    gauss_seidel.run();
+
+    REQUIRE( jacobi.converged );
+    REQUIRE( gauss_seidel.converged );
+    for (int s = 0; s < mdp.ns; s++)
+    {
+        REQUIRE( std::abs(jacobi.V[s] - gauss_seidel.V[s]) < 1e-6 );
+        // V is a fixed point of the Bellman operator, up to the precision
+        REQUIRE( std::abs(jacobi.Q[s][jacobi.greedy_policy[s]] - jacobi.V[s]) < 1e-8 );
+    }
+}
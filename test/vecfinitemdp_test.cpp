@@ -0,0 +1,77 @@
+#include <vector>
+#include <cmath>
+#include "catch.hpp"
+#include "mdp.h"
+
+TEST_CASE( "Testing VecFiniteMDP", "[vecfinitemdp]" )
+{
+    mdp::Chain chain(3);
+    int n_envs = 5;
+    mdp::VecFiniteMDP env(chain, n_envs, 42);
+    REQUIRE( env.size() == n_envs );
+    REQUIRE( env.ns == 3 );
+    REQUIRE( env.na == 2 );
+
+    // deterministic chain: 0 -> 1 -> 2 (terminal) with action 0, back to 0 with action 1
+    mdp::StepBatch out;
+    std::vector<int> actions = {0, 0, 1, 0, 0};
+    env.step(actions.data(), out);
+    REQUIRE( out.size() == n_envs );
+    REQUIRE( out.next_states == std::vector<int>({1, 1, 0, 1, 1}) );
+    REQUIRE( env.states == std::vector<int>({1, 1, 0, 1, 1}) );
+
+    // slots reaching the terminal state are done and reset to the default state
+    env.step(actions.data(), out);
+    REQUIRE( out.next_states == std::vector<int>({2, 2, 0, 2, 2}) );
+    REQUIRE( out.rewards == std::vector<double>({1.0, 1.0, 0.0, 1.0, 1.0}) );
+    REQUIRE( out.dones == std::vector<unsigned char>({1, 1, 0, 1, 1}) );
+    REQUIRE( env.states == std::vector<int>({0, 0, 0, 0, 0}) );
+    REQUIRE( env.episode_steps == std::vector<int>({0, 0, 2, 0, 0}) );
+
+    // horizon
+    mdp::VecFiniteMDP env_horizon(chain, 2, 42, 1);
+    std::vector<int> back = {1, 1};
+    env_horizon.step(back.data(), out);
+    REQUIRE( out.dones == std::vector<unsigned char>({1, 1}) );
+}
+
+TEST_CASE( "Testing VecFiniteMDP sampling", "[vecfinitemdp_sampling]" )
+{
+    mdp::GridWorld gridworld(4, 4, 0.3, 0.1);
+    int n_envs = 64;
+    int n_steps = 500;
+    std::vector<int> actions(n_envs);
+    for (int i = 0; i < n_envs; i++) actions[i] = i % gridworld.na;
+
+    // frequency of the next states of (default_state, a), from slots that are always reset
+    mdp::VecFiniteMDP env(gridworld, n_envs, 7, 1);
+    utils::vec::vec_2d counts = utils::vec::get_zeros_2d(gridworld.na, gridworld.ns);
+    mdp::StepBatch out;
+    for (int t = 0; t < n_steps; t++)
+    {
+        env.step(actions.data(), out);
+        for (int i = 0; i < n_envs; i++) counts[actions[i]][out.next_states[i]] += 1;
+    }
+    int s0 = gridworld.default_state;
+    for (int a = 0; a < gridworld.na; a++)
+    {
+        double total = n_steps*n_envs/gridworld.na;
+        for (int sn = 0; sn < gridworld.ns; sn++)
+            REQUIRE( std::abs(counts[a][sn]/total - gridworld.transitions.prob(s0, a, sn)) < 0.03 );
+    }
+
+    // the trajectory of a slot only depends on the seed, its index and its actions
+    mdp::VecFiniteMDP env1(gridworld, 8, 3);
+    mdp::VecFiniteMDP env2(gridworld, 3, 3);
+    mdp::StepBatch out1, out2;
+    for (int t = 0; t < 100; t++)
+    {
+        env1.step(actions.data(), out1);
+        env2.step(actions.data(), out2);
+        for (int i = 0; i < 3; i++)
+        {
+            REQUIRE( out1.next_states[i] == out2.next_states[i] );
+            REQUIRE( out1.rewards[i] == out2.rewards[i] );
+        }
+    }
+}
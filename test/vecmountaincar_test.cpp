@@ -0,0 +1,71 @@
+#include <vector>
+#include <cmath>
+#include "catch.hpp"
+#include "mdp.h"
+
+TEST_CASE( "Testing VecMountainCar cosine", "[vecmountaincar_cosine]" )
+{
+    for (int i = 0; i <= 10000; i++)
+    {
+        double x = -3.6 + 5.4*i/10000;
+        REQUIRE( std::abs(mdp::VecMountainCar::cosine(x) - std::cos(x)) < 1e-15 );
+    }
+}
+
+TEST_CASE( "Testing VecMountainCar", "[vecmountaincar]" )
+{
+    int n_envs = 37;
+    utils::rand::Random randgen(3);
+    std::vector<int> actions(n_envs);
+
+    // the scalar and SIMD kernels give the same results
+    mdp::VecMountainCar env(n_envs, 5, 100);
+    mdp::VecMountainCar env_scalar(n_envs, 5, 100);
+    env_scalar.use_simd = false;
+    REQUIRE( env_scalar.instruction_set() == "scalar" );
+    mdp::MountainCarStepBatch out, out_scalar;
+    for (int t = 0; t < 500; t++)
+    {
+        for (int i = 0; i < n_envs; i++) actions[i] = std::min(2, (int) (3*randgen.sample_real_uniform(0, 1)));
+        env.step(actions.data(), out);
+        env_scalar.step(actions.data(), out_scalar);
+        REQUIRE( out.positions == out_scalar.positions );
+        REQUIRE( out.velocities == out_scalar.velocities );
+        REQUIRE( out.rewards == out_scalar.rewards );
+        REQUIRE( out.dones == out_scalar.dones );
+        REQUIRE( env.positions == env_scalar.positions );
+        for (int i = 0; i < n_envs; i++)
+        {
+            REQUIRE( (env.positions[i] >= -1.2 && env.positions[i] <= 0.6) );
+            REQUIRE( std::abs(env.velocities[i]) <= 0.07 );
+            REQUIRE( env.episode_steps[i] < 100 );
+        }
+    }
+
+    // same dynamics as MountainCar
+    mdp::MountainCar mountain_car;
+    mountain_car.reset();
+    mdp::VecMountainCar single(1);
+    single.positions[0] = mountain_car.state[0];
+    for (int t = 0; t < 200; t++)
+    {
+        int action = (t / 20) % 2 == 0 ? 0 : 2;
+        mdp::StepResult<mdp::StaticState<2>> result = mountain_car.step(action);
+        single.step(&action, out);
+        REQUIRE( std::abs(out.positions[0] - result.next_state[0]) < 1e-12 );
+        REQUIRE( std::abs(out.velocities[0] - result.next_state[1]) < 1e-12 );
+        REQUIRE( out.rewards[0] == result.reward );
+        if (result.done) break;
+    }
+
+    // a car reaching the goal is done and reset
+    single.positions[0] = 0.59;
+    single.velocities[0] = 0.05;
+    int action = 2;
+    single.step(&action, out);
+    REQUIRE( out.positions[0] == 0.6 );
+    REQUIRE( out.dones[0] == 1 );
+    REQUIRE( out.rewards[0] == 1.0 );
+    REQUIRE( single.velocities[0] == 0 );
+    REQUIRE( single.episode_steps[0] == 0 );
+}